@@ -0,0 +1,176 @@
+#ifndef PSRS_INDEX_HPP
+#define PSRS_INDEX_HPP
+
+// Query service over a sorted partition. The splitters, the size and the
+// min/max key of every part are replicated on all ranks; a query finds the
+// owning rank with one binary search over the splitters and is answered
+// there by an rpc that searches the local part, either with a plain binary
+// search or over an Eytzinger (BFS order) copy of it, which keeps the top
+// levels of the search tree in a few cache lines.
+
+#include <upcxx/upcxx.hpp>
+#include <algorithm>
+#include <vector>
+#include "partition.hpp"
+
+namespace psrs
+{
+// Sorted keys stored in Eytzinger order: node k has children 2k and 2k+1,
+// slot 0 is unused. pos[k] is the index of node k in sorted order.
+template <typename T>
+class eytzinger
+{
+public:
+    eytzinger() = default;
+    explicit eytzinger(const std::vector<T> &sorted) : tree_(sorted.size() + 1), pos_(sorted.size() + 1)
+    {
+        std::size_t i = 0;
+        build(sorted, i, 1);
+    }
+
+    // index of the first key not less than key, or n
+    std::size_t lower_bound(const T &key) const
+    {
+        std::size_t n = tree_.size() - 1;
+        std::size_t k = 1;
+        while (k <= n)
+            k = 2 * k + (tree_[k] < key);
+        k >>= __builtin_ffsll(~k); // undo the right turns taken after the answer
+        return k == 0 ? n : pos_[k];
+    }
+
+private:
+    void build(const std::vector<T> &sorted, std::size_t &i, std::size_t k)
+    {
+        if (k >= tree_.size())
+            return;
+        build(sorted, i, 2 * k);
+        pos_[k] = i;
+        tree_[k] = sorted[i++];
+        build(sorted, i, 2 * k + 1);
+    }
+
+    std::vector<T> tree_{};
+    std::vector<std::size_t> pos_{};
+};
+
+enum class local_search
+{
+    binary,
+    eytzinger
+};
+
+template <typename T>
+class range_index
+{
+public:
+    // Collective. part must stay alive and unchanged while the index is
+    // used; every rank has to be done querying before any rank destroys it.
+    range_index(const partition<T> &part, local_search mode = local_search::eytzinger)
+        : splitters_(part.splitters), shard_(shard{&part.local, {}, mode})
+    {
+        if (mode == local_search::eytzinger)
+            shard_->eyt = eytzinger<T>(part.local);
+
+        long long n = part.local.size();
+        auto sizes = allgather(n);
+        offsets_.assign(sizes.size() + 1, 0);
+        for (std::size_t r = 0; r < sizes.size(); r++)
+            offsets_[r + 1] = offsets_[r] + sizes[r];
+        // empty parts contribute a default key, never read since their size is 0
+        mins_ = allgather(part.local.empty() ? T{} : part.local.front());
+        maxs_ = allgather(part.local.empty() ? T{} : part.local.back());
+    }
+
+    const std::vector<T> &splitters() const { return splitters_; }
+    long long size() const { return offsets_.back(); }
+    long long part_size(int r) const { return offsets_[r + 1] - offsets_[r]; }
+    const T &min(int r) const { return mins_[r]; }
+    const T &max(int r) const { return maxs_[r]; }
+
+    // Global position of the first key not less than key.
+    upcxx::future<long long> lower_bound(const T &key)
+    {
+        int r = owner(key);
+        if (r == upcxx::rank_n() || !(mins_[r] < key))
+            return upcxx::make_future(offsets_[r]);
+        long long base = offsets_[r];
+        return upcxx::rpc(r, [](upcxx::dist_object<shard> &s, T key) { return s->lower_bound(key); }, shard_, key)
+            .then([base](long long i) { return base + i; });
+    }
+
+    // Whether key is in the dataset.
+    upcxx::future<bool> contains(const T &key)
+    {
+        int r = owner(key);
+        if (r == upcxx::rank_n() || key < mins_[r])
+            return upcxx::make_future(false);
+        return upcxx::rpc(r, [](upcxx::dist_object<shard> &s, T key) {
+            auto i = s->lower_bound(key);
+            return i < s->keys->size() && !(key < (*s->keys)[i]);
+        }, shard_, key);
+    }
+
+    // All keys in [lo, hi), one rpc per part the range overlaps.
+    upcxx::future<std::vector<T>> range(const T &lo, const T &hi)
+    {
+        upcxx::future<std::vector<T>> keys = upcxx::make_future(std::vector<T>{});
+        if (!(lo < hi))
+            return keys;
+        int first = owner(lo);
+        int last = std::min(owner(hi), upcxx::rank_n() - 1);
+        for (int r = first; r <= last; r++)
+        {
+            if (part_size(r) == 0 || maxs_[r] < lo || !(mins_[r] < hi))
+                continue;
+            auto part = upcxx::rpc(r, [](upcxx::dist_object<shard> &s, T lo, T hi) {
+                auto b = begin(*s->keys);
+                return std::vector<T>(b + s->lower_bound(lo), b + s->lower_bound(hi));
+            }, shard_, lo, hi);
+            keys = upcxx::when_all(keys, part).then([](std::vector<T> a, std::vector<T> b) {
+                a.insert(end(a), begin(b), end(b));
+                return a;
+            });
+        }
+        return keys;
+    }
+
+private:
+    // this rank's part, as seen by the rpcs
+    struct shard
+    {
+        const std::vector<T> *keys;
+        eytzinger<T> eyt;
+        local_search mode;
+
+        std::size_t lower_bound(const T &key) const
+        {
+            if (mode == local_search::eytzinger)
+                return eyt.lower_bound(key);
+            return std::lower_bound(begin(*keys), end(*keys), key) - begin(*keys);
+        }
+    };
+
+    // First non-empty part whose largest key is not less than key, rank_n
+    // if there is none. Starts at the part the splitters route key to; the
+    // min/max only correct it for empty parts and for runs of equal keys
+    // straddling a part boundary after rebalance.
+    int owner(const T &key) const
+    {
+        int r = owner_of(splitters_, key);
+        while (r > 0 && (part_size(r - 1) == 0 || !(maxs_[r - 1] < key)))
+            r--;
+        while (r < upcxx::rank_n() && (part_size(r) == 0 || maxs_[r] < key))
+            r++;
+        return r;
+    }
+
+    std::vector<T> splitters_;
+    std::vector<long long> offsets_{}; // offsets_[r] global position of part r's first key
+    std::vector<T> mins_{};
+    std::vector<T> maxs_{};
+    upcxx::dist_object<shard> shard_;
+};
+} // namespace psrs
+
+#endif
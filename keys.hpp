@@ -0,0 +1,301 @@
+#ifndef PSRS_KEYS_HPP
+#define PSRS_KEYS_HPP
+
+// Order-preserving key normalization. Every supported key type is mapped
+// to an unsigned "normalized" key whose natural order (unsigned integer
+// compare, or memcmp for byte strings) matches the order of the original
+// values. The sorter only ever moves and compares normalized keys, values
+// are decoded back just for output.
+//
+//   int32_t / int64_t -> uint32_t / uint64_t   (flip the sign bit)
+//   float / double    -> uint32_t / uint64_t   (IEEE-754 sign flip trick)
+//   std::tuple<...>   -> key_bytes<N>          (big-endian column concatenation)
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace psrs
+{
+// fixed-width byte string compared with memcmp, used for composite keys
+template <std::size_t N>
+struct key_bytes
+{
+    unsigned char b[N];
+
+    friend bool operator<(const key_bytes &x, const key_bytes &y) { return std::memcmp(x.b, y.b, N) < 0; }
+    friend bool operator>(const key_bytes &x, const key_bytes &y) { return std::memcmp(x.b, y.b, N) > 0; }
+    friend bool operator<=(const key_bytes &x, const key_bytes &y) { return std::memcmp(x.b, y.b, N) <= 0; }
+    friend bool operator>=(const key_bytes &x, const key_bytes &y) { return std::memcmp(x.b, y.b, N) >= 0; }
+    friend bool operator==(const key_bytes &x, const key_bytes &y) { return std::memcmp(x.b, y.b, N) == 0; }
+    friend bool operator!=(const key_bytes &x, const key_bytes &y) { return std::memcmp(x.b, y.b, N) != 0; }
+};
+
+// big-endian store/load of an unsigned integer, so byte order == numeric order
+template <typename U>
+inline void store_be(unsigned char *p, U x)
+{
+    for (int i = sizeof(U) - 1; i >= 0; i--)
+    {
+        p[i] = static_cast<unsigned char>(x & 0xff);
+        x = static_cast<U>(x >> 8);
+    }
+}
+
+template <typename U>
+inline U load_be(const unsigned char *p)
+{
+    U x = 0;
+    for (std::size_t i = 0; i < sizeof(U); i++)
+        x = static_cast<U>(x << 8 | p[i]);
+    return x;
+}
+
+template <typename T, typename Enable = void>
+struct key_traits; // {
+//     using norm_type = ...;                 // unsigned, trivially copyable
+//     static norm_type encode(T);
+//     static T decode(norm_type);
+//     static norm_type max();                // greatest normalized key
+//     static bool read(std::istream&, T&);
+//     static void write(std::ostream&, const T&);
+// };
+
+// unsigned integers are already normalized
+template <typename T>
+struct key_traits<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type>
+{
+    using norm_type = T;
+    static norm_type encode(T x) { return x; }
+    static T decode(norm_type u) { return u; }
+    static norm_type max() { return std::numeric_limits<norm_type>::max(); }
+    static bool read(std::istream &is, T &x) { return static_cast<bool>(is >> x); }
+    static void write(std::ostream &os, const T &x) { os << x; }
+};
+
+// signed integers: two's complement with the sign bit flipped
+template <typename T>
+struct key_traits<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>
+{
+    using norm_type = typename std::make_unsigned<T>::type;
+    static constexpr norm_type sign_bit = norm_type(1) << (8 * sizeof(T) - 1);
+
+    static norm_type encode(T x) { return static_cast<norm_type>(x) ^ sign_bit; }
+    static T decode(norm_type u) { return static_cast<T>(u ^ sign_bit); }
+    static norm_type max() { return std::numeric_limits<norm_type>::max(); }
+    static bool read(std::istream &is, T &x) { return static_cast<bool>(is >> x); }
+    static void write(std::ostream &os, const T &x) { os << x; }
+};
+
+// IEEE-754: positive values get the sign bit set, negative values get all
+// bits inverted. -0.0 sorts just below +0.0, NaNs sort outside +-inf.
+template <typename T>
+struct key_traits<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static_assert(std::numeric_limits<T>::is_iec559, "floating point keys must be IEEE-754");
+    using norm_type = typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type;
+    static_assert(sizeof(norm_type) == sizeof(T), "unsupported floating point width");
+    static constexpr norm_type sign_bit = norm_type(1) << (8 * sizeof(T) - 1);
+
+    static norm_type encode(T x)
+    {
+        norm_type u;
+        std::memcpy(&u, &x, sizeof(T));
+        return (u & sign_bit) ? ~u : (u | sign_bit);
+    }
+    static T decode(norm_type u)
+    {
+        u = (u & sign_bit) ? (u & ~sign_bit) : ~u;
+        T x;
+        std::memcpy(&x, &u, sizeof(T));
+        return x;
+    }
+    static norm_type max() { return std::numeric_limits<norm_type>::max(); }
+    static bool read(std::istream &is, T &x) { return static_cast<bool>(is >> x); }
+    static void write(std::ostream &os, const T &x) { os << x; }
+};
+
+// total width in bytes of the normalized columns
+template <typename... Cols>
+struct norm_width;
+template <>
+struct norm_width<>
+{
+    static constexpr std::size_t value = 0;
+};
+template <typename Col, typename... Cols>
+struct norm_width<Col, Cols...>
+{
+    static_assert(std::is_unsigned<typename key_traits<Col>::norm_type>::value,
+                  "composite key columns must be scalar");
+    static constexpr std::size_t value = sizeof(typename key_traits<Col>::norm_type) + norm_width<Cols...>::value;
+};
+
+// composite keys: columns normalized one by one and concatenated big-endian,
+// so memcmp order is lexicographic column order. Columns are read whitespace
+// separated and written comma separated.
+template <typename... Cols>
+struct key_traits<std::tuple<Cols...>>
+{
+    using tuple_type = std::tuple<Cols...>;
+    using norm_type = key_bytes<norm_width<Cols...>::value>;
+
+    static norm_type encode(const tuple_type &x)
+    {
+        return encode(x, std::index_sequence_for<Cols...>{});
+    }
+    static tuple_type decode(const norm_type &k)
+    {
+        return decode(k, std::index_sequence_for<Cols...>{});
+    }
+    static norm_type max()
+    {
+        norm_type k;
+        std::memset(k.b, 0xff, sizeof(k.b));
+        return k;
+    }
+    static bool read(std::istream &is, tuple_type &x)
+    {
+        return read(is, x, std::index_sequence_for<Cols...>{});
+    }
+    static void write(std::ostream &os, const tuple_type &x)
+    {
+        write(os, x, std::index_sequence_for<Cols...>{});
+    }
+
+private:
+    template <std::size_t... I>
+    static norm_type encode(const tuple_type &x, std::index_sequence<I...>)
+    {
+        norm_type k;
+        unsigned char *p = k.b;
+        int unpack[] = {0, (store_be(p, key_traits<Cols>::encode(std::get<I>(x))),
+                            p += sizeof(typename key_traits<Cols>::norm_type), 0)...};
+        (void)unpack;
+        return k;
+    }
+    template <std::size_t... I>
+    static tuple_type decode(const norm_type &k, std::index_sequence<I...>)
+    {
+        tuple_type x;
+        const unsigned char *p = k.b;
+        int unpack[] = {0, (std::get<I>(x) = key_traits<Cols>::decode(
+                                load_be<typename key_traits<Cols>::norm_type>(p)),
+                            p += sizeof(typename key_traits<Cols>::norm_type), 0)...};
+        (void)unpack;
+        return x;
+    }
+    template <std::size_t... I>
+    static bool read(std::istream &is, tuple_type &x, std::index_sequence<I...>)
+    {
+        bool ok = true;
+        int unpack[] = {0, (ok = ok && key_traits<Cols>::read(is, std::get<I>(x)), 0)...};
+        (void)unpack;
+        return ok;
+    }
+    template <std::size_t... I>
+    static void write(std::ostream &os, const tuple_type &x, std::index_sequence<I...>)
+    {
+        int unpack[] = {0, (os << (I == 0 ? "" : ","), key_traits<Cols>::write(os, std::get<I>(x)), 0)...};
+        (void)unpack;
+    }
+};
+
+// Leading 64 bits of a normalized key as an unsigned integer. Keys that
+// differ here compare the same way as their prefixes, so byte string keys
+// are radix sorted on prefixes and fall back to a full compare only on ties.
+template <typename U>
+inline typename std::enable_if<std::is_unsigned<U>::value, std::uint64_t>::type
+key_prefix(U k)
+{
+    return static_cast<std::uint64_t>(k) << (64 - 8 * sizeof(U));
+}
+
+template <std::size_t N>
+inline std::uint64_t key_prefix(const key_bytes<N> &k)
+{
+    std::uint64_t x = 0;
+    for (std::size_t i = 0; i < 8; i++)
+        x = x << 8 | (i < N ? k.b[i] : 0);
+    return x;
+}
+
+// LSD radix sort of `v` on the unsigned `digits(e)`, one byte per pass over
+// the low `bits` bits. Passes where every element has the same digit are
+// skipped.
+template <typename T, typename Digits>
+void radix_sort(std::vector<T> &v, unsigned bits, Digits digits)
+{
+    std::vector<T> tmp(v.size());
+    for (unsigned shift = 0; shift < bits; shift += 8)
+    {
+        std::size_t count[256] = {};
+        for (const auto &e : v)
+            count[(digits(e) >> shift) & 0xff]++;
+        if (count[(digits(v[0]) >> shift) & 0xff] == v.size())
+            continue;
+        std::size_t sum = 0;
+        for (auto &c : count)
+        {
+            std::size_t t = c;
+            c = sum;
+            sum += t;
+        }
+        for (const auto &e : v)
+            tmp[count[(digits(e) >> shift) & 0xff]++] = e;
+        v.swap(tmp);
+    }
+}
+
+// unsigned normalized keys: radix sort on the whole key
+template <typename U>
+typename std::enable_if<std::is_unsigned<U>::value>::type
+sort_keys(std::vector<U> &keys)
+{
+    if (keys.size() < 64)
+    {
+        std::sort(begin(keys), end(keys));
+        return;
+    }
+    radix_sort(keys, 8 * sizeof(U), [](U k) { return k; });
+}
+
+// byte string keys: radix sort on the 64-bit prefixes, then memcmp sort of
+// each run of equal prefixes (only when keys are longer than the prefix)
+template <std::size_t N>
+void sort_keys(std::vector<key_bytes<N>> &keys)
+{
+    if (keys.size() < 64)
+    {
+        std::sort(begin(keys), end(keys));
+        return;
+    }
+    std::vector<std::pair<std::uint64_t, key_bytes<N>>> pk(keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++)
+        pk[i] = std::make_pair(key_prefix(keys[i]), keys[i]);
+    radix_sort(pk, 64, [](const std::pair<std::uint64_t, key_bytes<N>> &e) { return e.first; });
+    for (std::size_t lo = 0; lo < pk.size();)
+    {
+        std::size_t hi = lo + 1;
+        while (hi < pk.size() && pk[hi].first == pk[lo].first)
+            hi++;
+        if (N > 8 && hi - lo > 1)
+            std::sort(begin(pk) + lo, begin(pk) + hi,
+                      [](const std::pair<std::uint64_t, key_bytes<N>> &x, const std::pair<std::uint64_t, key_bytes<N>> &y) {
+                          return x.second < y.second;
+                      });
+        for (std::size_t i = lo; i < hi; i++)
+            keys[i] = pk[i].second;
+        lo = hi;
+    }
+}
+} // namespace psrs
+
+#endif
@@ -4,43 +4,71 @@
 #include <sstream>
 #include <algorithm>
 #include <numeric>
+#include <functional>
 #include <vector>
 #include <future>
 #include <limits>
 #include <utility>
+#include <cstdint>
+#include <tuple>
+#include "keys.hpp"
+#include "strings.hpp"
+#include "partition.hpp"
+#include "index.hpp"
 
 using namespace std;
 
-int main(int argc, char *argv[])
+// command line options, see main()
+struct options
 {
-    // setup UPC++ runtime
-    upcxx::init();
+    string input_file = "example.txt";
+    string key_type = "int";
+    string state_dir{};          // keep the sorted partition here between runs
+    bool append = false;         // merge input_file into the dataset in state_dir
+    double max_imbalance = 1.25; // rebalance after append when max/avg part size exceeds this
+    int max_runs = 8;            // compact after append when more runs than this are stored
+    double max_skew = 1.5;       // resample pivots when max/avg bucket size exceeds this
+    string query_file{};         // queries answered by rank 0 against the sorted parts
+};
+
+// Reads keys of type Key from input_file, normalized.
+template <typename Key>
+vector<typename psrs::key_traits<Key>::norm_type> read_keys(const string &input_file)
+{
+    using traits = psrs::key_traits<Key>;
+    vector<typename traits::norm_type> data{};
+    ifstream ifile;
+    ifile.open(input_file);
+    Key t;
+    while (traits::read(ifile, t))
+        data.push_back(traits::encode(t));
+    ifile.close();
+    return data;
+}
+
+// Sorts keys of type Key read from input_file. All phases work on the
+// normalized representation (see keys.hpp), values are decoded only when
+// the result is written out. Returns this rank's sorted part together
+// with the pivots from Phase III. Pivots are resampled while the largest
+// bucket exceeds max_skew times the average.
+template <typename Key>
+psrs::partition<typename psrs::key_traits<Key>::norm_type> psrs_sort(const string &input_file, double max_skew)
+{
+    using traits = psrs::key_traits<Key>;
+    using norm_t = typename traits::norm_type;
+
     int numprocs = upcxx::rank_n();
     int myid = upcxx::rank_me();
 
     // PHASE I
     // read data from file
     upcxx::global_ptr<int> global_data_size = nullptr;
-    upcxx::global_ptr<int> global_data = nullptr;
+    upcxx::global_ptr<norm_t> global_data = nullptr;
     if (myid == 0)
     {
-        string input_file;
-        if (argc == 2)
-            input_file = argv[1];
-        else
-            input_file = "example.txt";
-        ifstream ifile;
-        vector<int> data_to_sort{};
-        ifile.open(input_file);
-        while (!ifile.eof())
-        {
-            int t;
-            ifile >> t;
-            data_to_sort.push_back(t);
-        }
-        ifile.close();
+        vector<norm_t> data_to_sort = read_keys<Key>(input_file);
         global_data_size = upcxx::new_<int>(data_to_sort.size());
-        global_data = upcxx::new_array<int>(data_to_sort.size());
+        global_data = upcxx::new_array<norm_t>(data_to_sort.size());
         auto iter = global_data;
         for (int i = 0; i < data_to_sort.size(); i++)
         {
@@ -55,18 +83,18 @@ int main(int argc, char *argv[])
     auto fut = rget(global_data_size);
     fut.wait();
     int size = fut.result();
+    vector<norm_t> local_data{};
     {
         int min_index = ceil(static_cast<double>(myid) / numprocs * size); //start from this index
         int limit = ceil(static_cast<double>(myid + 1) / numprocs * size);
         int max_index = limit > size ? size : limit; //end before this
-        vector<int> local_data{};
         for (int i = min_index; i < max_index; i++)
         {
             auto fut = rget(global_data + i);
             fut.wait();
             local_data.push_back(fut.result());
         }
-        sort(begin(local_data), end(local_data));
+        psrs::sort_keys(local_data);
         for (int i = 0; i < local_data.size(); i++)
             upcxx::rput(local_data[i], global_data + min_index + i).wait();
         // cout << "ID: " << myid << "  start  " << min_index << "   stop  " << max_index << endl;
@@ -74,43 +102,75 @@ int main(int argc, char *argv[])
 
     // PHASE III
     upcxx::barrier();
-    upcxx::global_ptr<int> final_data = nullptr;
+    upcxx::global_ptr<norm_t> final_data = nullptr;
     upcxx::global_ptr<int> data_part = nullptr;
+    upcxx::global_ptr<norm_t> global_pivots = nullptr;
     if (myid == 0)
+        global_pivots = upcxx::new_array<norm_t>(numprocs);
+    global_pivots = upcxx::broadcast(global_pivots, 0).wait();
+    // Exact bucket sizes are counted (binary search in every sorted slice
+    // plus an allreduce) before any data moves; while the largest bucket
+    // is more than max_skew times the average, the pivots are drawn again
+    // from twice as many samples per slice.
+    int max_slice = ceil(static_cast<double>(size) / numprocs);
+    int oversample = 1;
+    double skew = 1.0;
+    vector<norm_t> pivots(numprocs - 1);
+    while (true)
     {
-        vector<int> piv{};
-        for (int i = 0; i < numprocs; i++) //each thread
+        if (myid == 0)
         {
-            int min_index = ceil(static_cast<double>(i) / numprocs * size); //start from this index
-            int limit = ceil(static_cast<double>(i + 1) / numprocs * size);
-            int max_index = limit > size ? size : limit; //end before this
-            for (int j = 0; j < numprocs; j++)
-            { //find thread_nr pivots
-                auto fut = rget(global_data + min_index + round(j * static_cast<double>(max_index - min_index) / (numprocs)));
-                fut.wait();
-                piv.push_back(fut.result());
+            int samples = numprocs * oversample; //per slice
+            vector<norm_t> piv{};
+            for (int i = 0; i < numprocs; i++) //each thread
+            {
+                int min_index = ceil(static_cast<double>(i) / numprocs * size); //start from this index
+                int limit = ceil(static_cast<double>(i + 1) / numprocs * size);
+                int max_index = limit > size ? size : limit; //end before this
+                if (max_index == min_index)
+                    continue;
+                for (int j = 0; j < samples; j++)
+                { //find thread_nr pivots
+                    int s = min(min_index + int(round(j * static_cast<double>(max_index - min_index) / samples)), max_index - 1);
+                    auto fut = rget(global_data + s);
+                    fut.wait();
+                    piv.push_back(fut.result());
+                }
             }
+            sort(begin(piv), end(piv));
+            for (int i = 1; i < numprocs; i++) //select pivots value
+                pivots[i - 1] = piv.empty() ? traits::max() : piv[i * piv.size() / numprocs];
+            upcxx::rput(pivots.data(), global_pivots, pivots.size()).wait();
         }
-        sort(begin(piv), end(piv));
-        // cout << "Piv: ";
-        // for (const auto &e : piv)
-        //     cout << e << " ";
-        // cout << endl;
-        vector<int> pivots{};
-        final_data = upcxx::new_array<int>(size);
-        for (int i = 1; i < numprocs; i++) //select pivots value
-            pivots.push_back(piv[numprocs * i]);
-        pivots.push_back(std::numeric_limits<int>::max()); //fake max pivot for iteration in phase iv
-
-        // cout << "Pivots: ";
-        // for (const auto &e : pivots)
-        //     cout << e << " ";
-        // cout << endl;
+        upcxx::barrier();
+        upcxx::rget(global_pivots, pivots.data(), pivots.size()).wait();
+
+        vector<long long> counts(numprocs); //keys of each bucket, same rule as phase iv
+        auto lo = begin(local_data);
+        for (int b = 0; b < numprocs; b++)
+        {
+            auto hi = b < numprocs - 1 ? lower_bound(lo, end(local_data), pivots[b]) : end(local_data);
+            counts[b] = hi - lo;
+            lo = hi;
+        }
+        upcxx::allreduce(counts.data(), counts.data(), counts.size(), plus<long long>()).wait();
+        if (size > 0)
+            skew = static_cast<double>(*max_element(begin(counts), end(counts))) * numprocs / size;
+        // once every key is a sample, more samples cannot help
+        if (skew <= max_skew || numprocs * oversample >= max_slice)
+            break;
+        oversample *= 2;
+    }
+    if (myid == 0 && oversample > 1)
+        cout << "Resampled with " << oversample << "x samples, bucket skew " << skew << endl;
+
+    if (myid == 0)
+    {
+        final_data = upcxx::new_array<norm_t>(size);
+        pivots.push_back(traits::max()); //fake max pivot for iteration in phase iv
 
         // PHASE IV
-        vector<vector<int>> merge_data{};//size of local tables when size%numrpocs!=0 will slightly change
-        for (int i = 0; i < numprocs; i++)
-            merge_data.push_back(*new vector<int>());
+        vector<vector<norm_t>> merge_data(numprocs); //size of local tables when size%numrpocs!=0 will slightly change
         vector<int> ind(numprocs); //indexes for iteration over final_data
         fill(begin(ind), end(ind), 0);
         vector<pair<int, int>> piv_ind{}; //pivot's indexes <start, max> for each thread
@@ -121,11 +181,7 @@ int main(int argc, char *argv[])
             int max_index = limit > size ? size : limit; //end before this
             piv_ind.push_back(make_pair(min_index, max_index));
         }
-        // cout << "Pivots indexes: ";
-        // for (const auto &e : piv_ind)
-        //     cout << get<0>(e) << ":" << get<1>(e) << " ";
-        // cout << endl;
-        data_part = upcxx::new_<int>(numprocs);
+        data_part = upcxx::new_array<int>(numprocs);
 
         for (int i = 0; i < numprocs; i++)
         {                     //each thread
@@ -135,8 +191,9 @@ int main(int argc, char *argv[])
             {
                 auto fut = rget(global_data + j + get<0>(piv_ind[i]));
                 fut.wait();
-                int v = fut.result();
-                if (v < pivots[curr_piv])
+                norm_t v = fut.result();
+                // the last bucket takes everything left, including keys equal to the fake max pivot
+                if (curr_piv == numprocs - 1 || v < pivots[curr_piv])
                 {
                     merge_data[curr_piv].push_back(v);
                     ind[curr_piv]++;
@@ -149,18 +206,6 @@ int main(int argc, char *argv[])
                 }
             }
         }
-        // cout << "Ind: ";
-        // for (const auto &e : ind)
-        //     cout << e << " ";
-        // cout << endl;
-
-        // cout << "Merge_data: " << endl;
-        // for (const auto &e : merge_data)
-        // {
-        //     for (const auto &f : e)
-        //         cout << f << " ";
-        //     cout << endl;
-        // }
 
         int t = 0;
         int d = 0;
@@ -181,6 +226,9 @@ int main(int argc, char *argv[])
     final_data = upcxx::broadcast(final_data, 0).wait();
     data_part = upcxx::broadcast(data_part, 0).wait();
 
+    psrs::partition<norm_t> part{};
+    part.splitters.assign(begin(pivots), begin(pivots) + numprocs - 1);
+
     // PHASE V
     {
         int min_index;
@@ -195,24 +243,25 @@ int main(int argc, char *argv[])
         auto fut = rget(data_part + myid);
         fut.wait();
         int max_index = fut.result();
-        vector<int> local_data{};
+        vector<norm_t> local_data{};
         for (int i = min_index; i < max_index; i++)
         {
             auto fut = rget(final_data + i);
             fut.wait();
             local_data.push_back(fut.result());
         }
-        sort(begin(local_data), end(local_data));
+        psrs::sort_keys(local_data);
         for (int i = 0; i < local_data.size(); i++)
             upcxx::rput(local_data[i], final_data + min_index + i).wait();
         // cout << "ID: " << myid << "  start  " << min_index << "   stop  " << max_index << endl;
+        part.local = move(local_data);
     }
 
     upcxx::barrier();
     //Check if sorted
     if (myid == 0)
     {
-        vector<int> check{};
+        vector<norm_t> check{};
         for (int i = 0; i < size; i++)
         {
             auto fut = rget(final_data + i);
@@ -223,64 +272,427 @@ int main(int argc, char *argv[])
         ofstream ofile;
         ofile.open("result.txt");
         for (auto &e : check)
-            ofile << e << " ";
+        {
+            traits::write(ofile, traits::decode(e));
+            ofile << " ";
+        }
+        ofile.close();
+        upcxx::delete_array(final_data);
+        upcxx::delete_array(data_part);
+        upcxx::delete_array(global_pivots);
+    }
+    return part;
+}
+
+// Incremental mode: adds the keys of input_file to the sorted dataset
+// kept in state_dir by an earlier run. The batch is split into slices as
+// in Phase II, each rank sorts its slice and partitions it against the
+// stored splitters; every rank stores the keys it receives as one more
+// sorted run of its part, so an append costs time and I/O in the batch
+// size only. The runs are merged into the parts (compacted) when more
+// than max_runs are stored or when max/avg part size exceeds
+// max_imbalance, in which case the parts are also rebalanced. The parts
+// are loaded in full only then, or when queries follow.
+template <typename Key>
+psrs::partition<typename psrs::key_traits<Key>::norm_type> psrs_append(const options &opt)
+{
+    using norm_t = typename psrs::key_traits<Key>::norm_type;
+
+    int numprocs = upcxx::rank_n();
+    int myid = upcxx::rank_me();
+
+    psrs::partition<norm_t> part{};
+    if (!psrs::load_splitters(part, opt.state_dir))
+    {
+        if (myid == 0)
+            cerr << "No dataset for " << numprocs << " ranks in " << opt.state_dir << endl;
+        return part;
+    }
+
+    // PHASE I
+    upcxx::global_ptr<int> global_data_size = nullptr;
+    upcxx::global_ptr<norm_t> global_data = nullptr;
+    if (myid == 0)
+    {
+        vector<norm_t> batch = read_keys<Key>(opt.input_file);
+        global_data_size = upcxx::new_<int>(batch.size());
+        global_data = upcxx::new_array<norm_t>(max<size_t>(batch.size(), 1));
+        upcxx::rput(batch.data(), global_data, batch.size()).wait();
+    }
+    global_data_size = upcxx::broadcast(global_data_size, 0).wait();
+    global_data = upcxx::broadcast(global_data, 0).wait();
+
+    // PHASE II
+    int size = rget(global_data_size).wait();
+    int min_index = ceil(static_cast<double>(myid) / numprocs * size); //start from this index
+    int limit = ceil(static_cast<double>(myid + 1) / numprocs * size);
+    int max_index = limit > size ? size : limit; //end before this
+    vector<norm_t> local_data(max_index - min_index);
+    upcxx::rget(global_data + min_index, local_data.data(), local_data.size()).wait();
+    upcxx::barrier();
+    if (myid == 0)
+    {
+        upcxx::delete_(global_data_size);
+        upcxx::delete_array(global_data);
+    }
+
+    // PHASE III-V against the stored splitters
+    if (!psrs::save_run(psrs::route_batch(part.splitters, move(local_data)), opt.state_dir))
+    {
+        if (myid == 0)
+            cerr << "Could not write the appended run to " << opt.state_dir << endl;
+        return {};
+    }
+
+    double imbalance = psrs::imbalance(psrs::stored_size<norm_t>(opt.state_dir));
+    int runs = upcxx::allreduce(psrs::stored_runs(opt.state_dir), [](int a, int b) { return max(a, b); }).wait();
+    bool rebalanced = imbalance > opt.max_imbalance;
+    bool compacted = rebalanced || runs > opt.max_runs;
+    if (compacted || !opt.query_file.empty())
+        psrs::load_state(part, opt.state_dir);
+    if (rebalanced)
+        psrs::rebalance(part);
+    if (compacted && !psrs::save_state(part, opt.state_dir))
+    {
+        if (myid == 0)
+            cerr << "Could not compact the dataset in " << opt.state_dir << endl;
+        return {};
+    }
+
+    if (myid == 0)
+        cout << "Appended " << size << " keys, imbalance " << imbalance
+             << (rebalanced ? ", rebalanced" : compacted ? ", compacted" : "") << endl;
+    return part;
+}
+
+// Answers the queries in query_file on rank 0, one per line:
+//   lower_bound key   global position of the first key not less than key
+//   contains key      1 if key is in the dataset
+//   range lo hi       keys in [lo, hi)
+template <typename Key>
+void run_queries(const psrs::partition<typename psrs::key_traits<Key>::norm_type> &part, const string &query_file)
+{
+    using traits = psrs::key_traits<Key>;
+
+    psrs::range_index<typename traits::norm_type> index(part);
+    if (upcxx::rank_me() == 0)
+    {
+        ifstream ifile;
+        ifile.open(query_file);
+        string query;
+        Key a, b;
+        while (ifile >> query)
+        {
+            if (query == "lower_bound" && traits::read(ifile, a))
+                cout << "lower_bound " << index.lower_bound(traits::encode(a)).wait() << endl;
+            else if (query == "contains" && traits::read(ifile, a))
+                cout << "contains " << index.contains(traits::encode(a)).wait() << endl;
+            else if (query == "range" && traits::read(ifile, a) && traits::read(ifile, b))
+            {
+                auto keys = index.range(traits::encode(a), traits::encode(b)).wait();
+                cout << "range " << keys.size() << ":";
+                for (const auto &k : keys)
+                {
+                    cout << " ";
+                    traits::write(cout, traits::decode(k));
+                }
+                cout << endl;
+            }
+            else
+            {
+                cerr << "Bad query: " << query << endl;
+                break;
+            }
+        }
+        ifile.close();
+    }
+    upcxx::barrier(); // keep the index alive until rank 0 is done
+}
+
+template <typename Key>
+void run(const options &opt)
+{
+    psrs::partition<typename psrs::key_traits<Key>::norm_type> part{};
+    if (opt.append)
+        part = psrs_append<Key>(opt);
+    else
+    {
+        part = psrs_sort<Key>(opt.input_file, opt.max_skew);
+        if (!opt.state_dir.empty() && !psrs::save_state(part, opt.state_dir) && upcxx::rank_me() == 0)
+            cerr << "Could not write the dataset to " << opt.state_dir << endl;
+    }
+    if (!opt.query_file.empty() && part.splitters.size() == static_cast<size_t>(upcxx::rank_n() - 1))
+        run_queries<Key>(part, opt.query_file);
+}
+
+// Reads strings [lo, hi) out of a global arena. Offsets of the returned
+// arena are rebased to zero, the original offset of string lo is stored
+// in char_base.
+psrs::string_arena fetch_strings(upcxx::global_ptr<char> chars, upcxx::global_ptr<uint64_t> offs,
+                                 int lo, int hi, uint64_t &char_base)
+{
+    psrs::string_arena a{};
+    a.offs.resize(hi - lo + 1);
+    upcxx::rget(offs + lo, a.offs.data(), a.offs.size()).wait();
+    char_base = a.offs[0];
+    for (auto &o : a.offs)
+        o -= char_base;
+    a.chars.resize(a.offs.back());
+    if (!a.chars.empty())
+        upcxx::rget(chars + char_base, a.chars.data(), a.chars.size()).wait();
+    return a;
+}
+
+// Writes a packed arena as strings [lo, lo + a.size()) of a global arena,
+// its characters starting at char_base. One rput for the characters and
+// one for the offsets.
+void store_strings(const psrs::string_arena &a, upcxx::global_ptr<char> chars, upcxx::global_ptr<uint64_t> offs,
+                   int lo, uint64_t char_base)
+{
+    if (!a.chars.empty())
+        upcxx::rput(a.chars.data(), chars + char_base, a.chars.size()).wait();
+    vector<uint64_t> o(begin(a.offs), end(a.offs));
+    for (auto &e : o)
+        e += char_base;
+    upcxx::rput(o.data(), offs + lo, o.size()).wait();
+}
+
+// Sorts newline separated string keys. Same phases as psrs_sort, but the
+// data is a character arena plus offset array (see strings.hpp): splitters
+// are compared as strings and every exchange moves packed character and
+// offset blocks. Phase V merges the sorted runs it receives instead of
+// sorting them again.
+void psrs_sort_strings(const string &input_file)
+{
+    int numprocs = upcxx::rank_n();
+    int myid = upcxx::rank_me();
+
+    // PHASE I
+    // read data from file, one key per line
+    upcxx::global_ptr<int> global_data_size = nullptr;
+    upcxx::global_ptr<char> global_chars = nullptr;
+    upcxx::global_ptr<uint64_t> global_offs = nullptr;
+    if (myid == 0)
+    {
+        psrs::string_arena data_to_sort{};
+        ifstream ifile;
+        ifile.open(input_file);
+        string line;
+        while (getline(ifile, line))
+            data_to_sort.push(line.data(), line.size());
+        ifile.close();
+        global_data_size = upcxx::new_<int>(data_to_sort.size());
+        global_chars = upcxx::new_array<char>(max<size_t>(data_to_sort.chars.size(), 1));
+        global_offs = upcxx::new_array<uint64_t>(data_to_sort.offs.size());
+        store_strings(data_to_sort, global_chars, global_offs, 0, 0);
+    }
+    global_data_size = upcxx::broadcast(global_data_size, 0).wait();
+    global_chars = upcxx::broadcast(global_chars, 0).wait();
+    global_offs = upcxx::broadcast(global_offs, 0).wait();
+
+    // PHASE II
+    auto fut = rget(global_data_size);
+    fut.wait();
+    int size = fut.result();
+    {
+        int min_index = ceil(static_cast<double>(myid) / numprocs * size); //start from this index
+        int limit = ceil(static_cast<double>(myid + 1) / numprocs * size);
+        int max_index = limit > size ? size : limit; //end before this
+        uint64_t char_base;
+        auto local_data = fetch_strings(global_chars, global_offs, min_index, max_index, char_base);
+        auto refs = local_data.refs();
+        psrs::sort_strings(refs);
+        store_strings(psrs::pack(refs), global_chars, global_offs, min_index, char_base);
+    }
+
+    // PHASE III
+    upcxx::barrier();
+    upcxx::global_ptr<char> final_chars = nullptr;
+    upcxx::global_ptr<uint64_t> final_offs = nullptr;
+    upcxx::global_ptr<int> data_part = nullptr;
+    upcxx::global_ptr<int> run_part = nullptr; //ends of the sorted runs inside each part
+    if (myid == 0)
+    {
+        psrs::string_arena samples{};
+        for (int i = 0; i < numprocs; i++) //each thread
+        {
+            int min_index = ceil(static_cast<double>(i) / numprocs * size); //start from this index
+            int limit = ceil(static_cast<double>(i + 1) / numprocs * size);
+            int max_index = limit > size ? size : limit; //end before this
+            if (max_index == min_index)
+                continue;
+            for (int j = 0; j < numprocs; j++)
+            { //find thread_nr pivots
+                int s = min(min_index + int(round(j * static_cast<double>(max_index - min_index) / (numprocs))), max_index - 1);
+                uint64_t char_base;
+                auto sample = fetch_strings(global_chars, global_offs, s, s + 1, char_base);
+                samples.push(sample[0]);
+            }
+        }
+        auto piv = samples.refs();
+        psrs::sort_strings(piv);
+        vector<psrs::string_ref> pivots{};
+        for (int i = 1; i < numprocs && !piv.empty(); i++) //select pivots value
+            pivots.push_back(piv[i * piv.size() / numprocs]);
+
+        // PHASE IV
+        vector<psrs::string_arena> merge_data(numprocs);
+        vector<int> runs(numprocs * numprocs); //runs[b * numprocs + i]: end of thread i's run in part b
+        for (int i = 0; i < numprocs; i++)
+        { //each thread
+            int min_index = ceil(static_cast<double>(i) / numprocs * size); //start from this index
+            int limit = ceil(static_cast<double>(i + 1) / numprocs * size);
+            int max_index = limit > size ? size : limit; //end before this
+            uint64_t char_base;
+            auto part = fetch_strings(global_chars, global_offs, min_index, max_index, char_base);
+            auto refs = part.refs();
+            size_t lo = 0;
+            for (int b = 0; b < numprocs; b++)
+            {
+                // part is sorted: everything below pivot b goes to bucket b
+                size_t hi = static_cast<size_t>(b) < pivots.size()
+                                ? lower_bound(begin(refs) + lo, end(refs), pivots[b]) - begin(refs)
+                                : refs.size();
+                for (size_t k = lo; k < hi; k++)
+                    merge_data[b].push(refs[k]);
+                runs[b * numprocs + i] = merge_data[b].size();
+                lo = hi;
+            }
+        }
+
+        uint64_t total_chars = 0;
+        for (const auto &e : merge_data)
+            total_chars += e.chars.size();
+        final_chars = upcxx::new_array<char>(max<uint64_t>(total_chars, 1));
+        final_offs = upcxx::new_array<uint64_t>(size + 1);
+        data_part = upcxx::new_array<int>(numprocs);
+        run_part = upcxx::new_array<int>(numprocs * numprocs);
+
+        int inx = 0;
+        uint64_t char_inx = 0;
+        for (int d = 0; d < numprocs; d++)
+        {
+            store_strings(merge_data[d], final_chars, final_offs, inx, char_inx);
+            inx += merge_data[d].size();
+            char_inx += merge_data[d].chars.size();
+            upcxx::rput(inx, data_part + d).wait();
+        }
+        if (size == 0)
+            upcxx::rput(uint64_t(0), final_offs).wait();
+        upcxx::rput(runs.data(), run_part, runs.size()).wait();
+        upcxx::delete_array(global_chars);
+        upcxx::delete_array(global_offs);
+    }
+    final_chars = upcxx::broadcast(final_chars, 0).wait();
+    final_offs = upcxx::broadcast(final_offs, 0).wait();
+    data_part = upcxx::broadcast(data_part, 0).wait();
+    run_part = upcxx::broadcast(run_part, 0).wait();
+
+    // PHASE V
+    {
+        int min_index;
+        if (myid == 0)
+            min_index = 0;
+        else
+        {
+            auto fut = rget(data_part + myid - 1);
+            fut.wait();
+            min_index = fut.result();
+        }
+        auto fut = rget(data_part + myid);
+        fut.wait();
+        int max_index = fut.result();
+        uint64_t char_base;
+        auto local_data = fetch_strings(final_chars, final_offs, min_index, max_index, char_base);
+        vector<int> run_end(numprocs);
+        upcxx::rget(run_part + myid * numprocs, run_end.data(), numprocs).wait();
+
+        auto refs = local_data.refs();
+        vector<psrs::lcp_run> runs(numprocs);
+        int lo = 0;
+        for (int i = 0; i < numprocs; i++)
+        {
+            runs[i].refs.assign(begin(refs) + lo, begin(refs) + run_end[i]);
+            runs[i].lcps = psrs::lcp_array(runs[i].refs);
+            lo = run_end[i];
+        }
+        store_strings(psrs::pack(psrs::lcp_merge_runs(move(runs))), final_chars, final_offs, min_index, char_base);
+    }
+
+    upcxx::barrier();
+    //Check if sorted
+    if (myid == 0)
+    {
+        uint64_t char_base;
+        auto check = fetch_strings(final_chars, final_offs, 0, size, char_base);
+        auto refs = check.refs();
+        cout << "Is it sorted: " << is_sorted(begin(refs), end(refs)) << endl;
+        ofstream ofile;
+        ofile.open("result.txt");
+        for (const auto &e : refs)
+        {
+            ofile.write(reinterpret_cast<const char *>(e.s), e.n);
+            ofile << "\n";
+        }
         ofile.close();
     }
-    //COUT TEST SECTION
-    // if (myid == 0)
-    //     cout << "liczba wątków: " << numprocs << endl;
-    // if (myid == 2)
-    // {
-    //     auto fut = rget(global_data_size);
-    //     fut.wait();
-    //     cout << "Ilosc elem: " << fut.result() << endl;
-    // }
-    // upcxx::barrier();
-    // if (myid == 2)
-    // {
-    //     for (int i = 0; i < numprocs - 1; i++)
-    //     {
-    //         auto fut = rget(pivots + i);
-    //         fut.wait();
-    //         cout << fut.result() << " ";
-    //     }
-    //     cout << endl;
-    // }
-    // if (myid == 2)
-    // {
-    //     cout << "Final data: ";
-    //     for (int i = 0; i < size; i++)
-    //     {
-    //         auto fut = rget(final_data + i);
-    //         fut.wait();
-    //         cout << fut.result() << " ";
-    //     }
-    //     cout << endl;
-    // }
-
-    // if (myid == 1)
-    // {
-    //     cout << "Data part: ";
-    //     for (int i = 0; i < numprocs; i++)
-    //     {
-    //         auto fut = rget(data_part + i);
-    //         fut.wait();
-    //         cout << fut.result() << " ";
-    //     }
-    //     cout << endl;
-    // }
-
-    // if (myid == 1)
-    // {
-    //     cout << "Global data: ";
-    //     for (int i = 0; i < size; i++)
-    //     {
-    //         auto fut = rget(global_data + i);
-    //         fut.wait();
-    //         cout << fut.result() << " ";
-    //     }
-    //     cout << endl;
-    // }
+}
+
+int main(int argc, char *argv[])
+{
+    // setup UPC++ runtime
+    upcxx::init();
+
+    // usage: program [--resample max_skew]
+    //                [--state dir [--append] [--rebalance max_imbalance] [--compact max_runs]]
+    //                [--query query_file] [input_file [key_type]]
+    // key_type: int (default), int64, double, pair (int64 timestamp, int64 id),
+    //           string (one key per line)
+    // --state keeps the sorted parts in dir, --append adds input_file to them,
+    // --query answers lookups against the sorted parts (see run_queries),
+    // --resample bounds the bucket skew accepted from sampling
+    options opt{};
+    vector<string> positional{};
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--state" && i + 1 < argc)
+            opt.state_dir = argv[++i];
+        else if (arg == "--append")
+            opt.append = true;
+        else if (arg == "--rebalance" && i + 1 < argc)
+            opt.max_imbalance = stod(argv[++i]);
+        else if (arg == "--compact" && i + 1 < argc)
+            opt.max_runs = stoi(argv[++i]);
+        else if (arg == "--resample" && i + 1 < argc)
+            opt.max_skew = stod(argv[++i]);
+        else if (arg == "--query" && i + 1 < argc)
+            opt.query_file = argv[++i];
+        else
+            positional.push_back(arg);
+    }
+    if (positional.size() >= 1)
+        opt.input_file = positional[0];
+    if (positional.size() >= 2)
+        opt.key_type = positional[1];
+
+    if (opt.append && opt.state_dir.empty())
+    {
+        if (upcxx::rank_me() == 0)
+            cerr << "--append requires --state" << endl;
+    }
+    else if (opt.key_type == "int")
+        run<int>(opt);
+    else if (opt.key_type == "int64")
+        run<int64_t>(opt);
+    else if (opt.key_type == "double")
+        run<double>(opt);
+    else if (opt.key_type == "pair")
+        run<tuple<int64_t, int64_t>>(opt);
+    else if (opt.key_type == "string" && opt.state_dir.empty() && opt.query_file.empty())
+        psrs_sort_strings(opt.input_file);
+    else if (upcxx::rank_me() == 0)
+        cerr << "Unsupported key type: " << opt.key_type << endl;
 
     // close down UPC++ runtime
     upcxx::finalize();
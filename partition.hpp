@@ -0,0 +1,380 @@
+#ifndef PSRS_PARTITION_HPP
+#define PSRS_PARTITION_HPP
+
+// Distributed sorted dataset: every rank holds one sorted part and a copy
+// of the splitters that separate the parts. Used to keep the result of a
+// PSRS run resident (on disk between runs) and to append new batches to it
+// without sorting the whole dataset again. On disk a part is a base file
+// plus one sorted run per appended batch, as in a log-structured merge
+// tree; runs are merged into the base only when the dataset is compacted.
+
+#include <upcxx/upcxx.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "keys.hpp"
+
+namespace psrs
+{
+template <typename T>
+struct partition
+{
+    std::vector<T> splitters{}; // rank_n-1 pivots, part r holds keys in [splitters[r-1], splitters[r])
+    std::vector<T> local{};     // this rank's sorted part
+};
+
+// Part a key belongs to: number of splitters not greater than it.
+template <typename T>
+int owner_of(const std::vector<T> &splitters, const T &key)
+{
+    return std::upper_bound(begin(splitters), end(splitters), key) - begin(splitters);
+}
+
+// Splits a sorted vector into one run per part, run r holding the keys
+// below splitters[r] (same rule as Phase IV).
+template <typename T>
+std::vector<std::vector<T>> split_by(const std::vector<T> &sorted, const std::vector<T> &splitters)
+{
+    std::vector<std::vector<T>> out(splitters.size() + 1);
+    auto lo = begin(sorted);
+    for (std::size_t b = 0; b <= splitters.size(); b++)
+    {
+        auto hi = b < splitters.size() ? std::lower_bound(lo, end(sorted), splitters[b]) : end(sorted);
+        out[b].assign(lo, hi);
+        lo = hi;
+    }
+    return out;
+}
+
+// Collective. Every rank's value, in rank order, gathered through an array
+// on rank 0.
+template <typename T>
+std::vector<T> allgather(const T &value)
+{
+    int numprocs = upcxx::rank_n();
+    int myid = upcxx::rank_me();
+
+    upcxx::global_ptr<T> values = nullptr;
+    if (myid == 0)
+        values = upcxx::new_array<T>(numprocs);
+    values = upcxx::broadcast(values, 0).wait();
+    upcxx::rput(value, values + myid).wait();
+    upcxx::barrier();
+
+    std::vector<T> all(numprocs);
+    upcxx::rget(values, all.data(), numprocs).wait();
+    upcxx::barrier();
+    if (myid == 0)
+        upcxx::delete_array(values);
+    return all;
+}
+
+// Collective all-to-all: sends out[r] to rank r. Returns what this rank
+// received, runs concatenated in sender rank order; run_end[r] is the end
+// of the run that came from rank r. Counts are published in a matrix on
+// rank 0, every receiver allocates one landing buffer and each sender
+// writes its run with a single rput at its precomputed offset.
+template <typename T>
+std::vector<T> all_to_all(const std::vector<std::vector<T>> &out, std::vector<int> &run_end)
+{
+    int numprocs = upcxx::rank_n();
+    int myid = upcxx::rank_me();
+
+    upcxx::global_ptr<int> counts = nullptr; //counts[src * numprocs + dst]
+    upcxx::global_ptr<upcxx::global_ptr<T>> landing = nullptr;
+    if (myid == 0)
+    {
+        counts = upcxx::new_array<int>(numprocs * numprocs);
+        landing = upcxx::new_array<upcxx::global_ptr<T>>(numprocs);
+    }
+    counts = upcxx::broadcast(counts, 0).wait();
+    landing = upcxx::broadcast(landing, 0).wait();
+
+    std::vector<int> row(numprocs);
+    for (int r = 0; r < numprocs; r++)
+        row[r] = out[r].size();
+    upcxx::rput(row.data(), counts + myid * numprocs, numprocs).wait();
+    upcxx::barrier();
+
+    std::vector<int> all(numprocs * numprocs);
+    upcxx::rget(counts, all.data(), all.size()).wait();
+    run_end.assign(numprocs, 0);
+    int incoming = 0;
+    for (int src = 0; src < numprocs; src++)
+    {
+        incoming += all[src * numprocs + myid];
+        run_end[src] = incoming;
+    }
+    auto buf = upcxx::new_array<T>(std::max(incoming, 1));
+    upcxx::rput(buf, landing + myid).wait();
+    upcxx::barrier();
+
+    std::vector<upcxx::global_ptr<T>> dst(numprocs);
+    upcxx::rget(landing, dst.data(), numprocs).wait();
+    for (int r = 0; r < numprocs; r++)
+    {
+        if (out[r].empty())
+            continue;
+        int offset = 0;
+        for (int src = 0; src < myid; src++)
+            offset += all[src * numprocs + r];
+        upcxx::rput(out[r].data(), dst[r] + offset, out[r].size()).wait();
+    }
+    upcxx::barrier();
+
+    std::vector<T> in(buf.local(), buf.local() + incoming);
+    upcxx::delete_array(buf);
+    if (myid == 0)
+    {
+        upcxx::delete_array(counts);
+        upcxx::delete_array(landing);
+    }
+    return in;
+}
+
+// Merges the sorted runs [run_end[i-1], run_end[i]) of v in place,
+// pairwise so every key is moved log(runs) times.
+template <typename T>
+void merge_runs(std::vector<T> &v, std::vector<int> run_end)
+{
+    while (run_end.size() > 1)
+    {
+        std::vector<int> next{};
+        for (std::size_t r = 0; r + 1 < run_end.size(); r += 2)
+        {
+            int lo = r == 0 ? 0 : run_end[r - 1];
+            std::inplace_merge(begin(v) + lo, begin(v) + run_end[r], begin(v) + run_end[r + 1]);
+            next.push_back(run_end[r + 1]);
+        }
+        if (run_end.size() % 2)
+            next.push_back(run_end.back());
+        run_end.swap(next);
+    }
+}
+
+// Collective. Routes this rank's share of a new batch to the parts that
+// own its keys: the share is sorted and split against the splitters.
+// Returns the keys that belong to this rank's part as one sorted run.
+// Only the batch is touched, the resident parts are not read.
+template <typename T>
+std::vector<T> route_batch(const std::vector<T> &splitters, std::vector<T> batch)
+{
+    sort_keys(batch);
+    std::vector<int> run_end{};
+    auto in = all_to_all(split_by(batch, splitters), run_end);
+    merge_runs(in, run_end);
+    return in;
+}
+
+// Collective. Largest part size over the average part size, n is the size
+// of this rank's part.
+inline double imbalance(long long n)
+{
+    long long total = upcxx::allreduce(n, [](long long a, long long b) { return a + b; }).wait();
+    long long largest = upcxx::allreduce(n, [](long long a, long long b) { return std::max(a, b); }).wait();
+    if (total == 0)
+        return 1.0;
+    return static_cast<double>(largest) * upcxx::rank_n() / total;
+}
+
+// Collective. Moves keys between neighbouring parts so that part r holds
+// global positions [ceil(r*size/numprocs), ceil((r+1)*size/numprocs)), the
+// same slicing Phase II uses, and recomputes the splitters from the new
+// part boundaries.
+template <typename T>
+void rebalance(partition<T> &part)
+{
+    int numprocs = upcxx::rank_n();
+    int myid = upcxx::rank_me();
+
+    // global position of this part's first key
+    long long n = part.local.size();
+    long long my_begin = upcxx::exclusive_scan(n, [](long long a, long long b) { return a + b; }, 0LL).wait();
+    long long size = upcxx::allreduce(n, [](long long a, long long b) { return a + b; }).wait();
+
+    // sizes plus first and last key of every new part, gathered on rank 0
+    upcxx::global_ptr<long long> sizes = nullptr;
+    upcxx::global_ptr<T> bounds = nullptr;
+    if (myid == 0)
+    {
+        sizes = upcxx::new_array<long long>(numprocs);
+        bounds = upcxx::new_array<T>(2 * numprocs);
+    }
+    sizes = upcxx::broadcast(sizes, 0).wait();
+    bounds = upcxx::broadcast(bounds, 0).wait();
+
+    std::vector<std::vector<T>> out(numprocs);
+    for (int r = 0; r < numprocs; r++)
+    {
+        long long min_index = std::ceil(static_cast<double>(r) / numprocs * size);
+        long long max_index = std::min<long long>(std::ceil(static_cast<double>(r + 1) / numprocs * size), size);
+        long long lo = std::max(min_index, my_begin) - my_begin;
+        long long hi = std::min<long long>(max_index, my_begin + part.local.size()) - my_begin;
+        if (lo < hi)
+            out[r].assign(begin(part.local) + lo, begin(part.local) + hi);
+    }
+    std::vector<int> run_end{};
+    part.local = all_to_all(out, run_end); // runs arrive in key order, no merge needed
+
+    if (!part.local.empty())
+    {
+        upcxx::rput(part.local.front(), bounds + 2 * myid).wait();
+        upcxx::rput(part.local.back(), bounds + 2 * myid + 1).wait();
+    }
+    upcxx::rput(static_cast<long long>(part.local.size()), sizes + myid).wait();
+    upcxx::barrier();
+
+    std::vector<long long> all(numprocs);
+    std::vector<T> b(2 * numprocs);
+    upcxx::rget(bounds, b.data(), b.size()).wait();
+    upcxx::rget(sizes, all.data(), numprocs).wait();
+    // splitter r-1 is the first key of part r; an empty part borrows the
+    // splitter of the part after it, or the largest key if none follows
+    T last = part.splitters.empty() ? T{} : part.splitters.back();
+    for (int r = 0; r < numprocs; r++)
+        if (all[r] != 0)
+            last = b[2 * r + 1];
+    for (int r = numprocs - 1; r >= 1; r--)
+        part.splitters[r - 1] = all[r] != 0 ? b[2 * r] : (r + 1 < numprocs ? part.splitters[r] : last);
+    upcxx::barrier();
+
+    if (myid == 0)
+    {
+        upcxx::delete_array(sizes);
+        upcxx::delete_array(bounds);
+    }
+}
+
+// State layout in dir, keys stored normalized:
+//   splitters.bin          the splitters, written by rank 0
+//   part_<rank>.bin        base of the part of each rank
+//   part_<rank>.run_<k>    k-th sorted run appended to it since the base
+inline std::string part_path(const std::string &dir)
+{
+    return dir + "/part_" + std::to_string(upcxx::rank_me()) + ".bin";
+}
+
+inline std::string run_path(const std::string &dir, int k)
+{
+    return dir + "/part_" + std::to_string(upcxx::rank_me()) + ".run_" + std::to_string(k);
+}
+
+// Collective. True on every rank if ok is true on every rank.
+inline bool all_ranks(bool ok)
+{
+    return upcxx::allreduce(static_cast<int>(ok), [](int a, int b) { return std::min(a, b); }).wait() != 0;
+}
+
+// Number of runs appended to this rank's part since its base was written.
+inline int stored_runs(const std::string &dir)
+{
+    int k = 0;
+    while (std::ifstream(run_path(dir, k)))
+        k++;
+    return k;
+}
+
+// Number of keys in a file, from its size alone.
+template <typename T>
+long long file_keys(const std::string &path)
+{
+    std::ifstream ifile(path, std::ios::binary | std::ios::ate);
+    if (!ifile)
+        return 0;
+    return static_cast<long long>(ifile.tellg()) / sizeof(T);
+}
+
+// Keys stored for this rank's part, base and runs, without reading them.
+template <typename T>
+long long stored_size(const std::string &dir)
+{
+    long long n = file_keys<T>(part_path(dir));
+    for (int k = 0, runs = stored_runs(dir); k < runs; k++)
+        n += file_keys<T>(run_path(dir, k));
+    return n;
+}
+
+template <typename T>
+std::vector<T> read_binary(const std::string &path)
+{
+    std::ifstream ifile(path, std::ios::binary | std::ios::ate);
+    if (!ifile)
+        return {};
+    std::vector<T> v(static_cast<std::size_t>(ifile.tellg()) / sizeof(T));
+    ifile.seekg(0);
+    ifile.read(reinterpret_cast<char *>(v.data()), v.size() * sizeof(T));
+    return v;
+}
+
+// Returns false if the file could not be created or fully written.
+template <typename T>
+bool write_binary(const std::string &path, const std::vector<T> &v)
+{
+    std::ofstream ofile(path, std::ios::binary);
+    ofile.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+    ofile.close();
+    return static_cast<bool>(ofile);
+}
+
+// Collective. Each rank writes its part as the base of a new state,
+// dropping the runs appended to the old one; rank 0 also writes the
+// splitters. Returns false on every rank if any rank could not write, a
+// rank that failed keeps its old base and runs.
+template <typename T>
+bool save_state(const partition<T> &part, const std::string &dir)
+{
+    int runs = stored_runs(dir);
+    bool ok = write_binary(part_path(dir), part.local);
+    if (upcxx::rank_me() == 0)
+        ok = write_binary(dir + "/splitters.bin", part.splitters) && ok;
+    if (ok)
+        for (int k = 0; k < runs; k++)
+            std::remove(run_path(dir, k).c_str());
+    return all_ranks(ok);
+}
+
+// Collective. Stores a run from route_batch as the next run of this
+// rank's part. Returns false on every rank, with no run stored, if any
+// rank could not write.
+template <typename T>
+bool save_run(const std::vector<T> &run, const std::string &dir)
+{
+    std::string path = run_path(dir, stored_runs(dir));
+    bool ok = all_ranks(write_binary(path, run));
+    if (!ok)
+        std::remove(path.c_str());
+    return ok;
+}
+
+// Reads the splitters of a state written by save_state with the same
+// number of ranks. Returns false if they do not match rank_n.
+template <typename T>
+bool load_splitters(partition<T> &part, const std::string &dir)
+{
+    part.splitters = read_binary<T>(dir + "/splitters.bin");
+    return part.splitters.size() == static_cast<std::size_t>(upcxx::rank_n() - 1);
+}
+
+// Loads a state written by save_state with the same number of ranks, the
+// runs appended since are merged into the part. Returns false (on every
+// rank) if the splitters do not match rank_n.
+template <typename T>
+bool load_state(partition<T> &part, const std::string &dir)
+{
+    part.local = read_binary<T>(part_path(dir));
+    std::vector<int> run_end{static_cast<int>(part.local.size())};
+    for (int k = 0, runs = stored_runs(dir); k < runs; k++)
+    {
+        auto run = read_binary<T>(run_path(dir, k));
+        part.local.insert(end(part.local), begin(run), end(run));
+        run_end.push_back(part.local.size());
+    }
+    merge_runs(part.local, run_end);
+    return load_splitters(part, dir);
+}
+} // namespace psrs
+
+#endif
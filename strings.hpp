@@ -0,0 +1,252 @@
+#ifndef PSRS_STRINGS_HPP
+#define PSRS_STRINGS_HPP
+
+// Variable-length string keys. Strings live back to back in a character
+// arena and are addressed through an offset array (offs[i]..offs[i+1]), so
+// no std::string is allocated per key. Local sorting is multikey quicksort
+// over string_refs, sorted runs are combined with an LCP-aware merge.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace psrs
+{
+// view of one string inside an arena
+struct string_ref
+{
+    const unsigned char *s;
+    std::size_t n;
+};
+
+// compares a and b, both known to share their first `depth` characters
+inline int compare(const string_ref &a, const string_ref &b, std::size_t depth = 0)
+{
+    std::size_t m = std::min(a.n, b.n);
+    if (m > depth)
+    {
+        int c = std::memcmp(a.s + depth, b.s + depth, m - depth);
+        if (c != 0)
+            return c;
+    }
+    return a.n < b.n ? -1 : (a.n > b.n ? 1 : 0);
+}
+
+inline bool operator<(const string_ref &a, const string_ref &b) { return compare(a, b) < 0; }
+
+// length of the common prefix of a and b, starting the scan at `depth`
+inline std::size_t lcp(const string_ref &a, const string_ref &b, std::size_t depth = 0)
+{
+    std::size_t m = std::min(a.n, b.n);
+    while (depth < m && a.s[depth] == b.s[depth])
+        depth++;
+    return depth;
+}
+
+// contiguous character arena plus offset array
+struct string_arena
+{
+    std::vector<char> chars{};
+    std::vector<std::uint64_t> offs{0};
+
+    std::size_t size() const { return offs.size() - 1; }
+
+    void push(const char *s, std::size_t n)
+    {
+        chars.insert(end(chars), s, s + n);
+        offs.push_back(chars.size());
+    }
+    void push(const string_ref &r) { push(reinterpret_cast<const char *>(r.s), r.n); }
+
+    string_ref operator[](std::size_t i) const
+    {
+        return string_ref{reinterpret_cast<const unsigned char *>(chars.data()) + offs[i], offs[i + 1] - offs[i]};
+    }
+
+    // views of every string, in arena order
+    std::vector<string_ref> refs() const
+    {
+        std::vector<string_ref> r{};
+        r.reserve(size());
+        for (std::size_t i = 0; i < size(); i++)
+            r.push_back((*this)[i]);
+        return r;
+    }
+};
+
+// builds a new arena holding the strings in the order of refs
+inline string_arena pack(const std::vector<string_ref> &refs)
+{
+    string_arena a{};
+    std::size_t total = 0;
+    for (const auto &r : refs)
+        total += r.n;
+    a.chars.reserve(total);
+    a.offs.reserve(refs.size() + 1);
+    for (const auto &r : refs)
+        a.push(r);
+    return a;
+}
+
+namespace detail
+{
+inline int char_at(const string_ref &r, std::size_t depth)
+{
+    return depth < r.n ? r.s[depth] : -1; // end of string sorts first
+}
+
+inline void insertion_sort(string_ref *a, std::size_t n, std::size_t depth)
+{
+    for (std::size_t i = 1; i < n; i++)
+    {
+        string_ref t = a[i];
+        std::size_t j = i;
+        for (; j > 0 && compare(t, a[j - 1], depth) < 0; j--)
+            a[j] = a[j - 1];
+        a[j] = t;
+    }
+}
+} // namespace detail
+
+// Bentley-Sedgewick multikey quicksort: three-way partition on the
+// character at `depth`, only the equal part moves on to the next character.
+inline void multikey_quicksort(string_ref *a, std::size_t n, std::size_t depth = 0)
+{
+    while (n > 1)
+    {
+        if (n < 16)
+        {
+            detail::insertion_sort(a, n, depth);
+            return;
+        }
+        int x = detail::char_at(a[0], depth);
+        int y = detail::char_at(a[n / 2], depth);
+        int z = detail::char_at(a[n - 1], depth);
+        int v = std::max(std::min(x, y), std::min(std::max(x, y), z)); // median of three
+
+        std::size_t lt = 0, i = 0, gt = n;
+        while (i < gt)
+        {
+            int c = detail::char_at(a[i], depth);
+            if (c < v)
+                std::swap(a[lt++], a[i++]);
+            else if (c > v)
+                std::swap(a[i], a[--gt]);
+            else
+                i++;
+        }
+        multikey_quicksort(a, lt, depth);
+        multikey_quicksort(a + gt, n - gt, depth);
+        if (v < 0) // equal part holds identical strings
+            return;
+        a += lt;
+        n = gt - lt;
+        depth++;
+    }
+}
+
+inline void sort_strings(std::vector<string_ref> &refs)
+{
+    multikey_quicksort(refs.data(), refs.size());
+}
+
+// lcps[i] = lcp(run[i-1], run[i]), lcps[0] = 0
+inline std::vector<std::size_t> lcp_array(const std::vector<string_ref> &run)
+{
+    std::vector<std::size_t> lcps(run.size(), 0);
+    for (std::size_t i = 1; i < run.size(); i++)
+        lcps[i] = lcp(run[i - 1], run[i]);
+    return lcps;
+}
+
+// sorted run together with its LCP array
+struct lcp_run
+{
+    std::vector<string_ref> refs{};
+    std::vector<std::size_t> lcps{};
+};
+
+// Binary LCP merge. h_a / h_b hold the lcp of the next candidate from each
+// run with the last string written out; whichever is larger is the smaller
+// string, and only on a tie are characters compared, starting past the
+// shared prefix.
+inline lcp_run lcp_merge(const lcp_run &a, const lcp_run &b)
+{
+    lcp_run out{};
+    out.refs.reserve(a.refs.size() + b.refs.size());
+    out.lcps.reserve(a.refs.size() + b.refs.size());
+    std::size_t i = 0, j = 0, h_a = 0, h_b = 0;
+    while (i < a.refs.size() && j < b.refs.size())
+    {
+        if (h_a > h_b)
+        {
+            out.refs.push_back(a.refs[i]);
+            out.lcps.push_back(h_a);
+            i++;
+            h_a = i < a.refs.size() ? a.lcps[i] : 0;
+        }
+        else if (h_a < h_b)
+        {
+            out.refs.push_back(b.refs[j]);
+            out.lcps.push_back(h_b);
+            j++;
+            h_b = j < b.refs.size() ? b.lcps[j] : 0;
+        }
+        else
+        {
+            std::size_t h = h_a;
+            std::size_t k = lcp(a.refs[i], b.refs[j], h);
+            if (compare(a.refs[i], b.refs[j], k) <= 0)
+            {
+                out.refs.push_back(a.refs[i]);
+                out.lcps.push_back(h);
+                i++;
+                h_a = i < a.refs.size() ? a.lcps[i] : 0;
+                h_b = k;
+            }
+            else
+            {
+                out.refs.push_back(b.refs[j]);
+                out.lcps.push_back(h);
+                j++;
+                h_b = j < b.refs.size() ? b.lcps[j] : 0;
+                h_a = k;
+            }
+        }
+    }
+    for (bool first = true; i < a.refs.size(); i++, first = false)
+    {
+        out.refs.push_back(a.refs[i]);
+        out.lcps.push_back(first ? h_a : a.lcps[i]);
+    }
+    for (bool first = true; j < b.refs.size(); j++, first = false)
+    {
+        out.refs.push_back(b.refs[j]);
+        out.lcps.push_back(first ? h_b : b.lcps[j]);
+    }
+    if (!out.lcps.empty())
+        out.lcps[0] = 0;
+    return out;
+}
+
+// merges k sorted runs pairwise, log(k) rounds of lcp_merge
+inline std::vector<string_ref> lcp_merge_runs(std::vector<lcp_run> runs)
+{
+    if (runs.empty())
+        return {};
+    while (runs.size() > 1)
+    {
+        std::vector<lcp_run> next{};
+        for (std::size_t r = 0; r + 1 < runs.size(); r += 2)
+            next.push_back(lcp_merge(runs[r], runs[r + 1]));
+        if (runs.size() % 2)
+            next.push_back(std::move(runs.back()));
+        runs.swap(next);
+    }
+    return std::move(runs[0].refs);
+}
+} // namespace psrs
+
+#endif
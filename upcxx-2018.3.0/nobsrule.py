@@ -334,6 +334,10 @@ def comp_version(cxt, src):
 def upcxx_assert_enabled(cxt):
   return bool(env('ASSERT', False))
 
+@rule()
+def upcxx_stats_enabled(cxt):
+  return bool(env('UPCXX_STATS', False))
+
 @rule(path_arg='src')
 @coroutine
 def comp_lang_pp(cxt, src, libset):
@@ -9,6 +9,7 @@ namespace upcxx {
   namespace detail {
     template<typename T, typename Op>
     struct allreduce_state {
+      team *tm;
       int incoming;
       Op op;
       T accum;
@@ -17,7 +18,7 @@ namespace upcxx {
       // Called after `accum` has been updated by child.
       void contributed(dist_object<allreduce_state> &this_obj);
       
-      // Called to disseminate result value to ranks [rank_me,rank_ub).
+      // Called to disseminate result value to team ranks [rank_me,rank_ub).
       void broadcast(
         dist_object<allreduce_state> &this_obj,
         T const &value,
@@ -26,11 +27,12 @@ namespace upcxx {
     };
   }
   
+  // Collective over `tm`.
   template<typename T1, typename BinaryOp,
            typename T = typename std::decay<T1>::type>
-  future<T> allreduce(T1 &&value, BinaryOp op) {
-    intrank_t rank_me = upcxx::rank_me();
-    intrank_t rank_n = upcxx::rank_n();
+  future<T> allreduce(T1 &&value, BinaryOp op, team &tm = upcxx::world()) {
+    intrank_t rank_me = tm.rank_me();
+    intrank_t rank_n = tm.rank_n();
     
     // Given the parent function which flips the least significant one-bit
     //   parent(r) = r & (r-1)
@@ -47,11 +49,13 @@ namespace upcxx {
     
     auto *state = new dist_object<detail::allreduce_state<T,BinaryOp>>(
       detail::allreduce_state<T,BinaryOp>{
+        &tm,
         incoming,
         std::move(op),
         std::forward<T1>(value),
         promise<T>{}
-      }
+      },
+      tm
     );
     
     future<T> result = (*state)->answer.get_future();
@@ -70,8 +74,8 @@ namespace upcxx {
       ) {
       
       if(0 == --this->incoming) {
-        intrank_t rank_me = upcxx::rank_me();
-        intrank_t rank_n = upcxx::rank_n();
+        intrank_t rank_me = this->tm->rank_me();
+        intrank_t rank_n = this->tm->rank_n();
         
         if(rank_me == 0)
           this->broadcast(this_obj, this->accum, rank_n);
@@ -80,7 +84,7 @@ namespace upcxx {
           // the least significant one-bit set to zero.
           intrank_t parent = rank_me & (rank_me-1);
           
-          rpc_ff(parent,
+          rpc_ff((*this->tm)[parent],
             [](dist_object<allreduce_state> &this_obj, T const &value) {
               this_obj->accum = this_obj->op(this_obj->accum, value);
               this_obj->contributed(this_obj);
@@ -98,7 +102,7 @@ namespace upcxx {
         intrank_t rank_ub
       ) {
       
-      intrank_t rank_me = upcxx::rank_me();
+      intrank_t rank_me = this->tm->rank_me();
       
       // binomial broadcast
       while(true) {
@@ -111,7 +115,7 @@ namespace upcxx {
         // has contributed. We send the dist_id and do an immediate
         // `here()` so the lambda doesn't pointlessly wait on a ready
         // future (as would happen if we sent dist_object&).
-        rpc_ff(mid,
+        rpc_ff((*this->tm)[mid],
           [=](dist_id<allreduce_state> this_id, T const &value) {
             dist_object<allreduce_state> &this_obj = this_id.here();
             this_obj->broadcast(this_obj, value, rank_ub);
@@ -0,0 +1,379 @@
+#ifndef _1610305a_da24_4111_b8c1_73745bc4b258
+#define _1610305a_da24_4111_b8c1_73745bc4b258
+
+#include <upcxx/backend.hpp>
+#include <upcxx/dist_object.hpp>
+#include <upcxx/packing.hpp>
+#include <upcxx/rpc.hpp>
+#include <upcxx/team.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace upcxx {
+  // Collective over `tm`. Element-wise reduction of every member's `n`
+  // elements at `src` into the `n` elements at `dst` on every member,
+  // `src` may equal `dst`. `n` must agree across members and neither
+  // buffer may be touched until the future is ready. `op` must be
+  // associative and commutative.
+  template<typename T, typename BinaryOp>
+  future<> allreduce(
+    T const *src, T *dst, std::size_t n,
+    BinaryOp op, team &tm = upcxx::world()
+  );
+  
+  namespace detail {
+    // Payloads of at least this many bytes (and one element per rank)
+    // use reduce-scatter + allgather, smaller ones the pipelined tree.
+    constexpr std::size_t allreduce_bulk_rsag_bytes = 64<<10;
+    // Chunk size of the pipelined tree.
+    constexpr std::size_t allreduce_bulk_chunk_bytes = 8<<10;
+    
+    ////////////////////////////////////////////////////////////////////
+    // Pipelined tree: the reduce and broadcast trees of allreduce(T),
+    // run independently per chunk so each chunk moves on as soon as its
+    // children have delivered it.
+    
+    template<typename T, typename Op>
+    struct allreduce_tree_state {
+      team *tm;
+      Op op;
+      T *dst;
+      std::size_t n, chunk_n;
+      // contributions each chunk still waits on, ours included
+      std::vector<int> incoming;
+      // chunks whose result has not reached this rank yet
+      std::size_t chunks_left;
+      promise<> done;
+      
+      std::size_t chunk_lo(std::size_t c) const { return c*chunk_n; }
+      std::size_t chunk_size(std::size_t c) const {
+        return std::min(chunk_n, n - chunk_lo(c));
+      }
+      
+      // Called after chunk `c` of `dst` has been updated by a child.
+      void contributed(dist_object<allreduce_tree_state> &this_obj, std::size_t c);
+      
+      // Called to disseminate chunk `c` to team ranks [rank_me,rank_ub).
+      // Deletes `this_obj` once every chunk got here.
+      void broadcast(
+        dist_object<allreduce_tree_state> &this_obj,
+        std::size_t c,
+        intrank_t rank_ub
+      );
+    };
+    
+    ////////////////////////////////////////////////////////////////////
+    // Rabenseifner: recursive halving reduce-scatter then recursive
+    // doubling allgather over the largest power of two `pof2` of ranks,
+    // so each rank moves about 2n elements whatever the team size. Ranks
+    // past `pof2` fold their data into rank-pof2 beforehand and get the
+    // result back from it afterwards.
+    
+    template<typename T, typename Op>
+    struct allreduce_rsag_state {
+      team *tm;
+      Op op;
+      T *dst;
+      std::size_t n;
+      intrank_t pof2;
+      int log_pof2;
+      promise<> done;
+      
+      // Step 0 is the fold-in, steps [1,log_pof2] halve, steps
+      // [log_pof2+1,2*log_pof2] double, step 2*log_pof2+1 hands the
+      // result to the folded-in rank.
+      int step;
+      bool sent;
+      // inbox[s]: payload of step s, may arrive steps early
+      std::vector<std::unique_ptr<std::vector<T>>> inbox;
+      // blocks [blo,bhi) of `dst`, out of pof2 equal ones, being worked
+      intrank_t blo, bhi;
+      
+      std::size_t block_lo(intrank_t b) const { return n*b/pof2; }
+      
+      void send(
+        dist_object<allreduce_rsag_state> &this_obj,
+        intrank_t peer, std::size_t lo, std::size_t hi
+      );
+      
+      // Runs steps until one is missing its payload. Deletes `this_obj`
+      // once done.
+      void advance(dist_object<allreduce_rsag_state> &this_obj);
+    };
+    
+    template<typename T, typename Op>
+    void allreduce_bulk_combine(Op &op, T *dst, std::vector<T> const &in) {
+      for(std::size_t i=0; i != in.size(); i++)
+        dst[i] = op(dst[i], in[i]);
+    }
+    
+    template<typename T, typename BinaryOp>
+    future<> allreduce_tree(T *dst, std::size_t n, BinaryOp op, team &tm) {
+      intrank_t rank_me = tm.rank_me();
+      intrank_t rank_n = tm.rank_n();
+      
+      // same children as allreduce(T)
+      int incoming = 0;
+      while(true) {
+        intrank_t child = rank_me | (intrank_t(1)<<incoming);
+        if(child == rank_me || rank_n <= child)
+          break;
+        incoming += 1;
+      }
+      incoming += 1; // add one for this rank
+      
+      std::size_t chunk_n = std::max<std::size_t>(1, allreduce_bulk_chunk_bytes/sizeof(T));
+      std::size_t chunks = std::max<std::size_t>(1, (n + chunk_n-1)/chunk_n);
+      
+      auto *state = new dist_object<allreduce_tree_state<T,BinaryOp>>(
+        allreduce_tree_state<T,BinaryOp>{
+          &tm,
+          std::move(op),
+          dst, n, chunk_n,
+          std::vector<int>(chunks, incoming),
+          chunks,
+          promise<>{}
+        },
+        tm
+      );
+      
+      future<> result = (*state)->done.get_future();
+      
+      // Our contribution is already in `dst`. The last of these could
+      // delete `state` before it returns.
+      for(std::size_t c=0; c != chunks; c++)
+        (*state)->contributed(*state, c);
+      
+      return result;
+    }
+    
+    template<typename T, typename Op>
+    void allreduce_tree_state<T,Op>::contributed(
+        dist_object<allreduce_tree_state> &this_obj,
+        std::size_t c
+      ) {
+      
+      if(0 == --this->incoming[c]) {
+        intrank_t rank_me = this->tm->rank_me();
+        intrank_t rank_n = this->tm->rank_n();
+        
+        if(rank_me == 0)
+          this->broadcast(this_obj, c, rank_n);
+        else {
+          intrank_t parent = rank_me & (rank_me-1);
+          
+          rpc_ff((*this->tm)[parent],
+            [](dist_object<allreduce_tree_state> &this_obj,
+               std::size_t c, trivial_chunk<T> const &chunk) {
+              allreduce_bulk_combine(
+                this_obj->op, this_obj->dst + this_obj->chunk_lo(c), chunk.elts
+              );
+              this_obj->contributed(this_obj, c);
+            },
+            this_obj, c,
+            trivial_chunk<T>{this->dst + this->chunk_lo(c), this->chunk_size(c), {}}
+          );
+        }
+      }
+    }
+    
+    template<typename T, typename Op>
+    void allreduce_tree_state<T,Op>::broadcast(
+        dist_object<allreduce_tree_state> &this_obj,
+        std::size_t c,
+        intrank_t rank_ub
+      ) {
+      
+      intrank_t rank_me = this->tm->rank_me();
+      
+      while(true) {
+        intrank_t mid = rank_me + (rank_ub-rank_me)/2;
+        
+        if(mid == rank_me)
+          break;
+        
+        // Everyone has contributed chunk `c`, so the object exists there.
+        rpc_ff((*this->tm)[mid],
+          [](dist_id<allreduce_tree_state> this_id,
+             std::size_t c, intrank_t rank_ub, trivial_chunk<T> const &chunk) {
+            dist_object<allreduce_tree_state> &this_obj = this_id.here();
+            std::copy(
+              chunk.elts.begin(), chunk.elts.end(),
+              this_obj->dst + this_obj->chunk_lo(c)
+            );
+            this_obj->broadcast(this_obj, c, rank_ub);
+          },
+          this_obj.id(), c, rank_ub,
+          trivial_chunk<T>{this->dst + this->chunk_lo(c), this->chunk_size(c), {}}
+        );
+        
+        rank_ub = mid;
+      }
+      
+      if(0 == --this->chunks_left) {
+        this->done.fulfill_result();
+        delete &this_obj;
+      }
+    }
+    
+    template<typename T, typename BinaryOp>
+    future<> allreduce_rsag(
+        T *dst, std::size_t n, BinaryOp op, team &tm,
+        intrank_t pof2, int log_pof2
+      ) {
+      auto *state = new dist_object<allreduce_rsag_state<T,BinaryOp>>(
+        allreduce_rsag_state<T,BinaryOp>{
+          &tm,
+          std::move(op),
+          dst, n,
+          pof2, log_pof2,
+          promise<>{},
+          /*step=*/0,
+          /*sent=*/false,
+          std::vector<std::unique_ptr<std::vector<T>>>(2*log_pof2 + 2),
+          /*blo=*/0, /*bhi=*/pof2
+        },
+        tm
+      );
+      
+      future<> result = (*state)->done.get_future();
+      
+      // This could delete `state` before it returns.
+      (*state)->advance(*state);
+      
+      return result;
+    }
+    
+    template<typename T, typename Op>
+    void allreduce_rsag_state<T,Op>::send(
+        dist_object<allreduce_rsag_state> &this_obj,
+        intrank_t peer, std::size_t lo, std::size_t hi
+      ) {
+      rpc_ff((*this->tm)[peer],
+        [](dist_object<allreduce_rsag_state> &this_obj,
+           int step, trivial_chunk<T> const &chunk) {
+          this_obj->inbox[step].reset(new std::vector<T>(std::move(chunk.elts)));
+          this_obj->advance(this_obj);
+        },
+        this_obj, this->step,
+        trivial_chunk<T>{this->dst + lo, hi - lo, {}}
+      );
+    }
+    
+    template<typename T, typename Op>
+    void allreduce_rsag_state<T,Op>::advance(
+        dist_object<allreduce_rsag_state> &this_obj
+      ) {
+      intrank_t rank_me = this->tm->rank_me();
+      intrank_t rank_n = this->tm->rank_n();
+      int const last = 2*this->log_pof2 + 1;
+      
+      while(true) {
+        std::unique_ptr<std::vector<T>> &in = this->inbox[this->step];
+        
+        if(this->step == 0) {
+          if(this->pof2 <= rank_me) {
+            this->send(this_obj, rank_me - this->pof2, 0, this->n);
+            this->step = last;
+            continue;
+          }
+          
+          if(rank_me + this->pof2 < rank_n) {
+            if(!in)
+              return; // resumed by the rpc delivering it
+            allreduce_bulk_combine(this->op, this->dst, *in);
+            in.reset();
+          }
+        }
+        else if(this->step <= this->log_pof2) {
+          // Keep the half of our blocks on our side of `mask`, send the
+          // other half to the peer across it.
+          intrank_t mask = this->pof2 >> this->step;
+          intrank_t peer = rank_me ^ mask;
+          intrank_t mid = this->blo + (this->bhi - this->blo)/2;
+          bool lower = 0 == (rank_me & mask);
+          
+          if(!this->sent) {
+            if(lower)
+              this->send(this_obj, peer, this->block_lo(mid), this->block_lo(this->bhi));
+            else
+              this->send(this_obj, peer, this->block_lo(this->blo), this->block_lo(mid));
+            this->sent = true;
+          }
+          
+          if(!in)
+            return;
+          
+          (lower ? this->bhi : this->blo) = mid;
+          allreduce_bulk_combine(this->op, this->dst + this->block_lo(this->blo), *in);
+          in.reset();
+        }
+        else if(this->step < last) {
+          // Swap our finished blocks for the peer's adjacent ones.
+          intrank_t mask = intrank_t(1) << (this->step - this->log_pof2 - 1);
+          intrank_t peer = rank_me ^ mask;
+          intrank_t width = this->bhi - this->blo;
+          
+          if(!this->sent) {
+            this->send(this_obj, peer, this->block_lo(this->blo), this->block_lo(this->bhi));
+            this->sent = true;
+          }
+          
+          if(!in)
+            return;
+          
+          if(0 == (rank_me & mask)) {
+            std::copy(in->begin(), in->end(), this->dst + this->block_lo(this->bhi));
+            this->bhi += width;
+          }
+          else {
+            this->blo -= width;
+            std::copy(in->begin(), in->end(), this->dst + this->block_lo(this->blo));
+          }
+          in.reset();
+        }
+        else {
+          if(this->pof2 <= rank_me) {
+            if(!in)
+              return;
+            std::copy(in->begin(), in->end(), this->dst);
+          }
+          else if(rank_me + this->pof2 < rank_n)
+            this->send(this_obj, rank_me + this->pof2, 0, this->n);
+          
+          this->done.fulfill_result();
+          delete &this_obj;
+          return;
+        }
+        
+        this->step += 1;
+        this->sent = false;
+      }
+    }
+  }
+  
+  template<typename T, typename BinaryOp>
+  future<> allreduce(
+      T const *src, T *dst, std::size_t n,
+      BinaryOp op, team &tm
+    ) {
+    if(src != dst)
+      std::copy(src, src + n, dst);
+    
+    intrank_t pof2 = 1;
+    int log_pof2 = 0;
+    while(2*pof2 <= tm.rank_n()) {
+      pof2 *= 2;
+      log_pof2 += 1;
+    }
+    
+    if(pof2 > 1 && std::size_t(pof2) <= n &&
+       detail::allreduce_bulk_rsag_bytes <= n*sizeof(T))
+      return detail::allreduce_rsag(dst, n, std::move(op), tm, pof2, log_pof2);
+    else
+      return detail::allreduce_tree(dst, n, std::move(op), tm);
+  }
+}
+#endif
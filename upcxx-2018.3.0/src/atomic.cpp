@@ -0,0 +1,141 @@
+#include <upcxx/atomic.hpp>
+#include <upcxx/backend/gasnet/runtime_internal.hpp>
+
+namespace gasnet = upcxx::backend::gasnet;
+
+using upcxx::atomic_op;
+
+namespace {
+  template<typename T>
+  struct gex_dt;
+  template<>
+  struct gex_dt<std::int32_t> { static constexpr gex_DT_t value = GEX_DT_I32; };
+  template<>
+  struct gex_dt<std::uint32_t> { static constexpr gex_DT_t value = GEX_DT_U32; };
+  template<>
+  struct gex_dt<std::int64_t> { static constexpr gex_DT_t value = GEX_DT_I64; };
+  template<>
+  struct gex_dt<std::uint64_t> { static constexpr gex_DT_t value = GEX_DT_U64; };
+  
+  gex_OP_t to_gex_op(atomic_op op) {
+    switch(op) {
+    case atomic_op::load:             return GEX_OP_GET;
+    case atomic_op::store:            return GEX_OP_SET;
+    case atomic_op::compare_exchange: return GEX_OP_FCAS;
+    case atomic_op::add:              return GEX_OP_ADD;
+    case atomic_op::fetch_add:        return GEX_OP_FADD;
+    case atomic_op::sub:              return GEX_OP_SUB;
+    case atomic_op::fetch_sub:        return GEX_OP_FSUB;
+    case atomic_op::inc:              return GEX_OP_INC;
+    case atomic_op::fetch_inc:        return GEX_OP_FINC;
+    case atomic_op::dec:              return GEX_OP_DEC;
+    case atomic_op::fetch_dec:        return GEX_OP_FDEC;
+    case atomic_op::min:              return GEX_OP_MIN;
+    case atomic_op::fetch_min:        return GEX_OP_FMIN;
+    case atomic_op::max:              return GEX_OP_MAX;
+    case atomic_op::fetch_max:        return GEX_OP_FMAX;
+    case atomic_op::bit_and:          return GEX_OP_AND;
+    case atomic_op::fetch_bit_and:    return GEX_OP_FAND;
+    case atomic_op::bit_or:           return GEX_OP_OR;
+    case atomic_op::fetch_bit_or:     return GEX_OP_FOR;
+    case atomic_op::bit_xor:          return GEX_OP_XOR;
+    default: /*atomic_op::fetch_bit_xor*/
+                                      return GEX_OP_FXOR;
+    }
+  }
+  
+  gex_Flags_t to_gex_flags(std::memory_order order) {
+    switch(order) {
+    case std::memory_order_relaxed:
+      return 0;
+    case std::memory_order_consume:
+    case std::memory_order_acquire:
+      return GEX_FLAG_AD_ACQ;
+    case std::memory_order_release:
+      return GEX_FLAG_AD_REL;
+    default: // acq_rel, seq_cst
+      return GEX_FLAG_AD_ACQ | GEX_FLAG_AD_REL;
+    }
+  }
+  
+  // overloads picking the type-specific gex_AD_OpNB_*
+  gex_Event_t ad_op_nb(gex_AD_t ad, std::int32_t *result, gex_Rank_t rank, void *addr,
+                       gex_OP_t op, std::int32_t op1, std::int32_t op2, gex_Flags_t flags) {
+    return gex_AD_OpNB_I32(ad, result, rank, addr, op, op1, op2, flags);
+  }
+  gex_Event_t ad_op_nb(gex_AD_t ad, std::uint32_t *result, gex_Rank_t rank, void *addr,
+                       gex_OP_t op, std::uint32_t op1, std::uint32_t op2, gex_Flags_t flags) {
+    return gex_AD_OpNB_U32(ad, result, rank, addr, op, op1, op2, flags);
+  }
+  gex_Event_t ad_op_nb(gex_AD_t ad, std::int64_t *result, gex_Rank_t rank, void *addr,
+                       gex_OP_t op, std::int64_t op1, std::int64_t op2, gex_Flags_t flags) {
+    return gex_AD_OpNB_I64(ad, result, rank, addr, op, op1, op2, flags);
+  }
+  gex_Event_t ad_op_nb(gex_AD_t ad, std::uint64_t *result, gex_Rank_t rank, void *addr,
+                       gex_OP_t op, std::uint64_t op1, std::uint64_t op2, gex_Flags_t flags) {
+    return gex_AD_OpNB_U64(ad, result, rank, addr, op, op1, op2, flags);
+  }
+}
+
+template<typename T>
+std::uintptr_t upcxx::detail::atomic_domain_create(
+    std::vector<atomic_op> const &ops
+  ) {
+  
+  gex_OP_t gex_ops = 0;
+  for(atomic_op op: ops)
+    gex_ops |= to_gex_op(op);
+  
+  gex_AD_t ad;
+  gex_AD_Create(&ad, gasnet::world_team, gex_dt<T>::value, gex_ops, /*flags*/0);
+  
+  return reinterpret_cast<std::uintptr_t>(ad);
+}
+
+void upcxx::detail::atomic_domain_destroy(std::uintptr_t ad) {
+  gex_AD_Destroy(reinterpret_cast<gex_AD_t>(ad));
+}
+
+template<typename T>
+void upcxx::detail::atomic_nb(
+    std::uintptr_t ad, atomic_op op,
+    T *result, intrank_t rank, T *addr,
+    T operand1, T operand2,
+    std::memory_order order,
+    gasnet::handle_cb *cb
+  ) {
+  
+  gex_Event_t h = ad_op_nb(
+    reinterpret_cast<gex_AD_t>(ad),
+    result, rank, addr,
+    to_gex_op(op), operand1, operand2,
+    to_gex_flags(order)
+  );
+  cb->handle = reinterpret_cast<uintptr_t>(h);
+  
+  gasnet::register_cb(cb);
+  gasnet::after_gasnet();
+}
+
+// instantiate for the four supported types
+
+#define UPCXX_ATOMIC_INSTANTIATE(T) \
+  template \
+  std::uintptr_t upcxx::detail::atomic_domain_create<T>( \
+    std::vector<atomic_op> const &ops \
+  ); \
+  template \
+  void upcxx::detail::atomic_nb<T>( \
+    std::uintptr_t ad, atomic_op op, \
+    T *result, upcxx::intrank_t rank, T *addr, \
+    T operand1, T operand2, \
+    std::memory_order order, \
+    gasnet::handle_cb *cb \
+  );
+
+UPCXX_ATOMIC_INSTANTIATE(std::int32_t)
+UPCXX_ATOMIC_INSTANTIATE(std::uint32_t)
+UPCXX_ATOMIC_INSTANTIATE(std::int64_t)
+UPCXX_ATOMIC_INSTANTIATE(std::uint64_t)
+
+#undef UPCXX_ATOMIC_INSTANTIATE
@@ -6,12 +6,22 @@
  */
 
 #include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
 #include <upcxx/backend.hpp>
 #include <upcxx/global_ptr.hpp>
 #include <upcxx/rpc.hpp>
 
+// atomic_domain completes through gasnet handles, same as rput/rget.
+#include <upcxx/backend/gasnet/runtime.hpp>
+
 namespace upcxx {
 
+	// rpc-based atomics: every operation is executed by the target rank's
+	// cpu during its progress. See atomic_domain below for atomics done by
+	// the network (or shared memory) without involving the target.
+
 	template <typename T>
 	future<T> atomic_get(global_ptr<T> p, std::memory_order order)	{
 		return rpc(p.where(), [](global_ptr<T> p) { return *p.local(); }, p);
@@ -32,6 +42,196 @@ namespace upcxx {
 							 p, val);
 	}
 	
+  //////////////////////////////////////////////////////////////////////
+  // atomic_domain: remote atomics on 32/64-bit integers built on gasnet
+  // atomic domains (gex_AD), so the operation is offloaded to the NIC or
+  // done directly through shared memory, without waiting for the target
+  // rank to make progress. Only values accessed exclusively through the
+  // same domain are atomic with respect to each other.
+  
+  enum class atomic_op : int {
+    load, store, compare_exchange,
+    add, fetch_add,
+    sub, fetch_sub,
+    inc, fetch_inc,
+    dec, fetch_dec,
+    min, fetch_min,
+    max, fetch_max,
+    bit_and, fetch_bit_and,
+    bit_or, fetch_bit_or,
+    bit_xor, fetch_bit_xor
+  };
+  
+  namespace detail {
+    // These are defined in atomic.cpp (where gasnet is visible) for T in
+    // {int32_t, uint32_t, int64_t, uint64_t}.
+    
+    // Collective over the world team.
+    template<typename T>
+    std::uintptr_t atomic_domain_create(std::vector<atomic_op> const &ops);
+    
+    void atomic_domain_destroy(std::uintptr_t ad);
+    
+    // Issues `op` against the word at (rank,addr). For fetching ops the
+    // old value is written to `*result` by the time `cb` fires. Fills in
+    // `cb->handle` and registers `cb` with backend.
+    template<typename T>
+    void atomic_nb(
+      std::uintptr_t ad, atomic_op op,
+      T *result, intrank_t rank, T *addr,
+      T operand1, T operand2,
+      std::memory_order order,
+      backend::gasnet::handle_cb *cb
+    );
+    
+    // Tracks a fetching atomic, fulfills with the fetched value.
+    template<typename T>
+    struct atomic_cb_fetch final: backend::gasnet::handle_cb {
+      T result;
+      promise<T> pro;
+      
+      void execute_and_delete(backend::gasnet::handle_cb_successor) {
+        pro.fulfill_result(std::move(result));
+        delete this;
+      }
+    };
+    
+    // Tracks a non-fetching atomic.
+    struct atomic_cb_nofetch final: backend::gasnet::handle_cb {
+      promise<> pro;
+      
+      void execute_and_delete(backend::gasnet::handle_cb_successor) {
+        pro.fulfill_result();
+        delete this;
+      }
+    };
+  }
+  
+  template<typename T>
+  class atomic_domain {
+    static_assert(
+      std::is_same<T, std::int32_t>::value || std::is_same<T, std::uint32_t>::value ||
+      std::is_same<T, std::int64_t>::value || std::is_same<T, std::uint64_t>::value,
+      "atomic_domain supports only 32 and 64-bit integer types."
+    );
+    
+    std::uintptr_t ad_ = 0;
+    std::uint32_t ops_ = 0; // bit (1<<op) set for every op in the domain
+    
+    future<T> fetching(atomic_op op, global_ptr<T> p, T op1, T op2, std::memory_order order) const {
+      UPCXX_ASSERT(ops_ & (1u<<int(op)), "Atomic operation not in this atomic_domain.");
+      auto *cb = new detail::atomic_cb_fetch<T>;
+      future<T> ans = cb->pro.get_future();
+      detail::atomic_nb<T>(ad_, op, &cb->result, p.rank_, p.raw_ptr_, op1, op2, order, cb);
+      return ans;
+    }
+    
+    future<> nonfetching(atomic_op op, global_ptr<T> p, T op1, std::memory_order order) const {
+      UPCXX_ASSERT(ops_ & (1u<<int(op)), "Atomic operation not in this atomic_domain.");
+      auto *cb = new detail::atomic_cb_nofetch;
+      future<> ans = cb->pro.get_future();
+      detail::atomic_nb<T>(ad_, op, nullptr, p.rank_, p.raw_ptr_, op1, T(), order, cb);
+      return ans;
+    }
+    
+  public:
+    // Collective over all ranks. Only the operations listed can be
+    // issued against this domain.
+    atomic_domain(std::vector<atomic_op> const &ops):
+      ad_{detail::atomic_domain_create<T>(ops)} {
+      for(atomic_op op: ops)
+        ops_ |= 1u<<int(op);
+    }
+    
+    atomic_domain(atomic_domain const&) = delete;
+    
+    atomic_domain(atomic_domain &&that):
+      ad_{that.ad_},
+      ops_{that.ops_} {
+      that.ad_ = 0;
+      that.ops_ = 0;
+    }
+    
+    // Collective. Must be called before the destructor runs, once every
+    // rank's operations on this domain have completed.
+    void destroy() {
+      if(ad_ != 0)
+        detail::atomic_domain_destroy(ad_);
+      ad_ = 0;
+      ops_ = 0;
+    }
+    
+    ~atomic_domain() {
+      UPCXX_ASSERT(ad_ == 0, "atomic_domain::destroy() must be called collectively before destructor.");
+    }
+    
+    future<T> load(global_ptr<T> p, std::memory_order order) const {
+      return fetching(atomic_op::load, p, T(), T(), order);
+    }
+    future<> store(global_ptr<T> p, T val, std::memory_order order) const {
+      return nonfetching(atomic_op::store, p, val, order);
+    }
+    // Replaces the value with `desired` if it equals `expected`. Produces
+    // the value held before, equal to `expected` iff the swap happened.
+    future<T> compare_exchange(global_ptr<T> p, T expected, T desired, std::memory_order order) const {
+      return fetching(atomic_op::compare_exchange, p, expected, desired, order);
+    }
+    
+    future<T> fetch_add(global_ptr<T> p, T val, std::memory_order order) const {
+      return fetching(atomic_op::fetch_add, p, val, T(), order);
+    }
+    future<> add(global_ptr<T> p, T val, std::memory_order order) const {
+      return nonfetching(atomic_op::add, p, val, order);
+    }
+    future<T> fetch_sub(global_ptr<T> p, T val, std::memory_order order) const {
+      return fetching(atomic_op::fetch_sub, p, val, T(), order);
+    }
+    future<> sub(global_ptr<T> p, T val, std::memory_order order) const {
+      return nonfetching(atomic_op::sub, p, val, order);
+    }
+    future<T> fetch_inc(global_ptr<T> p, std::memory_order order) const {
+      return fetching(atomic_op::fetch_inc, p, T(), T(), order);
+    }
+    future<> inc(global_ptr<T> p, std::memory_order order) const {
+      return nonfetching(atomic_op::inc, p, T(), order);
+    }
+    future<T> fetch_dec(global_ptr<T> p, std::memory_order order) const {
+      return fetching(atomic_op::fetch_dec, p, T(), T(), order);
+    }
+    future<> dec(global_ptr<T> p, std::memory_order order) const {
+      return nonfetching(atomic_op::dec, p, T(), order);
+    }
+    future<T> fetch_min(global_ptr<T> p, T val, std::memory_order order) const {
+      return fetching(atomic_op::fetch_min, p, val, T(), order);
+    }
+    future<> min(global_ptr<T> p, T val, std::memory_order order) const {
+      return nonfetching(atomic_op::min, p, val, order);
+    }
+    future<T> fetch_max(global_ptr<T> p, T val, std::memory_order order) const {
+      return fetching(atomic_op::fetch_max, p, val, T(), order);
+    }
+    future<> max(global_ptr<T> p, T val, std::memory_order order) const {
+      return nonfetching(atomic_op::max, p, val, order);
+    }
+    future<T> fetch_bit_and(global_ptr<T> p, T val, std::memory_order order) const {
+      return fetching(atomic_op::fetch_bit_and, p, val, T(), order);
+    }
+    future<> bit_and(global_ptr<T> p, T val, std::memory_order order) const {
+      return nonfetching(atomic_op::bit_and, p, val, order);
+    }
+    future<T> fetch_bit_or(global_ptr<T> p, T val, std::memory_order order) const {
+      return fetching(atomic_op::fetch_bit_or, p, val, T(), order);
+    }
+    future<> bit_or(global_ptr<T> p, T val, std::memory_order order) const {
+      return nonfetching(atomic_op::bit_or, p, val, order);
+    }
+    future<T> fetch_bit_xor(global_ptr<T> p, T val, std::memory_order order) const {
+      return fetching(atomic_op::fetch_bit_xor, p, val, T(), order);
+    }
+    future<> bit_xor(global_ptr<T> p, T val, std::memory_order order) const {
+      return nonfetching(atomic_op::bit_xor, p, val, order);
+    }
+  };
 } // namespace upcxx
 
 #endif
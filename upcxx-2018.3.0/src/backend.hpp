@@ -17,6 +17,12 @@ namespace upcxx {
   
   bool progress_required(persona_scope &ps = top_persona_scope());
   void discharge(persona_scope &ps = top_persona_scope());
+  
+  // Split-phase barrier: enters the barrier now, the future becomes ready
+  // during user-level progress once every rank has entered. Must be called
+  // with the master persona, in the same order relative to the other
+  // barrier_async() calls on all ranks.
+  future<> barrier_async();
 }
 
 ////////////////////////////////////////////////////////////////////////
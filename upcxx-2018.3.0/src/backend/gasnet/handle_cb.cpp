@@ -1,5 +1,6 @@
 #include <upcxx/backend/gasnet/handle_cb.hpp>
 #include <upcxx/backend/gasnet/runtime_internal.hpp>
+#include <upcxx/stats.hpp>
 
 using upcxx::backend::gasnet::handle_cb_queue;
 
@@ -8,28 +9,63 @@ static_assert(
   "Failed: sizeof(std::uintptr_t) == sizeof(gex_Event_t)"
 );
 
+thread_local upcxx::backend::gasnet::nbi_region_cb *upcxx::backend::gasnet::tl_nbi_region = nullptr;
+
 int handle_cb_queue::burst(int burst_n) {
   int exec_n = 0;
   handle_cb **pp = &this->head_;
   
-  while(burst_n-- && *pp != nullptr) {
-    handle_cb *p = *pp;
-    gex_Event_t ev = reinterpret_cast<gex_Event_t>(p->handle);
+  while(burst_n != 0 && *pp != nullptr) {
+    constexpr int batch_max = 16;
+    handle_cb *cbs[batch_max];
+    gex_Event_t evs[batch_max];
+    int batch_n = 0;
+    
+    for(handle_cb *p = *pp;
+        p != nullptr && batch_n != batch_max && batch_n != burst_n;
+        p = p->next_) {
+      cbs[batch_n] = p;
+      evs[batch_n] = reinterpret_cast<gex_Event_t>(p->handle);
+      batch_n += 1;
+    }
+    burst_n -= batch_n;
+    
+    // Invalidates the events it finds complete, invalid ones already were.
+    (void)gex_Event_TestSome(evs, batch_n, /*flags*/0);
     
-    if(0 == gex_Event_Test(ev)) {
-      // remove from queue
-      *pp = p->next_;
-      if(*pp == nullptr)
-        this->tailp_ = pp;
+    for(int i=0; i != batch_n; i++) {
+      // skip successors added by the previous callback, next burst tests them
+      while(*pp != cbs[i])
+        pp = &(*pp)->next_;
       
-      // do it!
-      p->execute_and_delete(handle_cb_successor{this, pp});
+      handle_cb *p = *pp;
       
-      exec_n += 1;
+      if(evs[i] == GEX_EVENT_INVALID) {
+        // remove from queue
+        *pp = p->next_;
+        if(*pp == nullptr)
+          this->tailp_ = pp;
+        
+        // do it!
+        p->execute_and_delete(handle_cb_successor{this, pp});
+        
+        exec_n += 1;
+      }
+      else
+        pp = &p->next_;
     }
-    else
-      pp = &p->next_;
   }
   
+  UPCXX_STATS_ADD(handle_cb_n, exec_n);
   return exec_n;
 }
+
+void upcxx::backend::gasnet::nbi_region_cb::execute_and_delete(
+    handle_cb_successor add
+  ) {
+  for(handle_cb *cb: this->cbs) {
+    cb->handle = reinterpret_cast<std::uintptr_t>(GEX_EVENT_INVALID);
+    add(cb);
+  }
+  delete this;
+}
@@ -2,8 +2,10 @@
 #define _740290a8_56e6_4fa4_b251_ff87c02bede0
 
 #include <upcxx/diagnostic.hpp>
+#include <upcxx/pooled.hpp>
 
 #include <cstdint>
+#include <vector>
 
 namespace upcxx {
 namespace backend {
@@ -17,13 +19,21 @@ namespace gasnet {
     void operator()(handle_cb *succ);
   };
   
-  struct handle_cb {
+  // Pooled: rput/rget/atomics allocate one per operation.
+  struct handle_cb: detail::pooled_new {
     handle_cb *next_ = reinterpret_cast<handle_cb*>(0x1);
     std::uintptr_t handle = 0;
     
     virtual void execute_and_delete(handle_cb_successor) = 0;
   };
 
+  // Handles one burst() call from progress tests at most. They are tested
+  // in batches with a single gasnet call each.
+  constexpr int handle_cb_burst_n = 64;
+  // Same for after_gasnet(), which runs after every injection and so
+  // only takes a glance.
+  constexpr int handle_cb_inject_burst_n = 4;
+  
   struct handle_cb_queue {
     handle_cb *head_ = nullptr;
     handle_cb **tailp_ = &this->head_;
@@ -32,11 +42,26 @@ namespace gasnet {
     handle_cb_queue() = default;
     handle_cb_queue(handle_cb_queue const&) = delete;
     
+    bool empty() const { return this->head_ == nullptr; }
+    
     void enqueue(handle_cb *cb);
     
     int burst(int burst_n);
   };
   
+  // Callbacks of the rput/rget's issued inside this thread's implicit-NBI
+  // access region (upcxx::rma_region). The region's end yields one event
+  // for all of them, this waits on it and then hands them to the queue
+  // as already complete.
+  struct nbi_region_cb final: handle_cb {
+    std::vector<handle_cb*> cbs;
+    
+    void execute_and_delete(handle_cb_successor add) override;
+  };
+  
+  // This thread's open region, null if none.
+  extern thread_local nbi_region_cb *tl_nbi_region;
+  
   ////////////////////////////////////////////////////////////////////
   
   inline void handle_cb_queue::enqueue(handle_cb *cb) {
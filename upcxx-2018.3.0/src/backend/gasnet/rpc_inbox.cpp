@@ -1,10 +1,104 @@
 #include <upcxx/backend/gasnet/rpc_inbox.hpp>
 #include <upcxx/command.hpp>
+#include <upcxx/stats.hpp>
+
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace gasnet = upcxx::backend::gasnet;
 
 using upcxx::backend::gasnet::rpc_inbox;
 using upcxx::future;
 using upcxx::parcel_reader;
 
+////////////////////////////////////////////////////////////////////////
+
+namespace {
+  // Every pooled buffer has this alignment, classes start at this size.
+  constexpr std::size_t landing_align = 64;
+  constexpr int landing_class_n = 16;
+  
+  // Largest pooled size, zero until landing_init().
+  std::size_t landing_max_ = 0;
+  // Freed buffers per class, reused from the back.
+  std::vector<void*> landing_free_[landing_class_n];
+  
+  #if UPCXX_BACKEND_GASNET_PAR
+    // Buffers are freed by whichever persona executed their rpc.
+    std::mutex landing_lock_;
+  #endif
+  
+  std::size_t landing_class_size(int cls) {
+    return landing_align << cls;
+  }
+  
+  // A flood leaves at most about this many idle bytes per class.
+  std::size_t landing_keep_n(int cls) {
+    std::size_t n = (std::size_t(1)<<20)/landing_class_size(cls);
+    return n < 16 ? 16 : n;
+  }
+}
+
+void gasnet::landing_init(std::size_t max_size) {
+  std::size_t ub = landing_align;
+  int cls = 0;
+  while(ub < max_size && cls+1 < landing_class_n) {
+    ub *= 2;
+    cls += 1;
+  }
+  landing_max_ = ub;
+}
+
+void* gasnet::landing_allocate(std::size_t size, std::size_t alignment, int &cls) {
+  if(size <= landing_max_ && alignment <= landing_align) {
+    cls = 0;
+    while(landing_class_size(cls) < size)
+      cls += 1;
+    
+    {
+      #if UPCXX_BACKEND_GASNET_PAR
+        std::lock_guard<std::mutex> locked{landing_lock_};
+      #endif
+      
+      std::vector<void*> &free = landing_free_[cls];
+      if(!free.empty()) {
+        void *buf = free.back();
+        free.pop_back();
+        return buf;
+      }
+    }
+    
+    size = landing_class_size(cls);
+    alignment = landing_align;
+  }
+  else
+    cls = -1;
+  
+  void *buf;
+  int ok = posix_memalign(&buf, alignment, size);
+  UPCXX_ASSERT_ALWAYS(ok == 0);
+  return buf;
+}
+
+void gasnet::landing_deallocate(void *buf, int cls) {
+  if(cls != -1) {
+    #if UPCXX_BACKEND_GASNET_PAR
+      std::lock_guard<std::mutex> locked{landing_lock_};
+    #endif
+    
+    std::vector<void*> &free = landing_free_[cls];
+    if(free.size() < landing_keep_n(cls)) {
+      free.push_back(buf);
+      return;
+    }
+  }
+  
+  std::free(buf);
+}
+
+////////////////////////////////////////////////////////////////////////
+
 int rpc_inbox::burst(int burst_n) {
   int exec_n = 0;
   rpc_message *m = this->head_;
@@ -18,7 +112,7 @@ int rpc_inbox::burst(int burst_n) {
     
     // delete buffer when future says its ok
     buf_done >> [=]() {
-      std::free(m->payload);
+      landing_deallocate(m->payload, m->landing_class);
     };
     
     exec_n += 1;
@@ -29,5 +123,6 @@ int rpc_inbox::burst(int burst_n) {
   if(m == nullptr)
     this->tailp_ = &this->head_;
   
+  UPCXX_STATS_ADD(rpc_n, exec_n);
   return exec_n;
 }
@@ -6,14 +6,25 @@
 
 #include <cstdint>
 #include <cstring>
-#include <cstdlib>
 
 namespace upcxx {
 namespace backend {
 namespace gasnet {
+  // Landing buffers for incoming messages, kept on LIFO free lists per
+  // power-of-2 size class up to the largest medium AM so a recycled
+  // buffer is likely still in cache. Bigger or over-aligned requests go
+  // to the heap. `cls` tells landing_deallocate() which it was.
+  void* landing_allocate(std::size_t size, std::size_t alignment, int &cls);
+  void landing_deallocate(void *buf, int cls);
+  
+  // Called by init() with the largest medium AM payload, no buffer is
+  // pooled before.
+  void landing_init(std::size_t max_size);
+  
   struct rpc_message {
     rpc_message *next_ = this;
     void *payload;
+    int landing_class;
     
     // Build copy of a packed command buffer (upcxx/command.hpp) as
     // a rpc_message.
@@ -36,6 +47,8 @@ namespace gasnet {
     
     void enqueue(rpc_message *m);
     
+    bool empty() const { return this->head_ == nullptr; }
+    
     int burst(int burst_n = 100);
   };
   
@@ -53,12 +66,12 @@ namespace gasnet {
     size_t msg_offset = msg_size;
     msg_size += sizeof(rpc_message);
     
-    void *msg_buf;
-    int ok = posix_memalign(&msg_buf, cmd_alignment, msg_size);
-    UPCXX_ASSERT_ALWAYS(ok == 0);
+    int cls;
+    void *msg_buf = landing_allocate(msg_size, cmd_alignment, cls);
     
     rpc_message *m = new((char*)msg_buf + msg_offset) rpc_message;
     m->payload = msg_buf;
+    m->landing_class = cls;
     
     // The (void**) casts *might* inform memcpy that it can assume word
     // alignment.
@@ -75,7 +88,7 @@ namespace gasnet {
     
     // delete buffer when future says its ok
     buf_done >> [this]() {
-      std::free(this->payload);
+      landing_deallocate(this->payload, this->landing_class);
     };
   }
   
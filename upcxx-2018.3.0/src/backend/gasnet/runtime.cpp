@@ -3,8 +3,12 @@
 #include <upcxx/backend/gasnet/rpc_inbox.hpp>
 
 #include <upcxx/os_env.hpp>
+#include <upcxx/rpc_aggregator.hpp>
+#include <upcxx/team.hpp>
 
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 #include <sched.h>
 #include <unistd.h>
@@ -65,6 +69,9 @@ persona_scope *backend::initial_master_scope = nullptr;
 // from: upcxx/backend/gasnet/runtime.hpp
 
 size_t gasnet::am_size_rdzv_cutover;
+size_t gasnet::am_size_medium_max;
+size_t gasnet::am_size_long_max;
+size_t gasnet::am_size_fused_max;
 
 #if UPCXX_BACKEND_GASNET_SEQ
   handle_cb_queue gasnet::master_hcbs;
@@ -89,22 +96,52 @@ namespace {
   enum {
     id_am_eager_restricted = GEX_AM_INDEX_BASE,
     id_am_eager_master,
-    id_am_eager_persona
+    id_am_eager_persona,
+    id_am_long_master,
+    id_am_long_master_reply
   };
     
   void am_eager_restricted(gex_Token_t, void *buf, size_t buf_size, gex_AM_Arg_t buf_align);
   void am_eager_master(gex_Token_t, void *buf, size_t buf_size, gex_AM_Arg_t buf_align_and_level);
   void am_eager_persona(gex_Token_t, void *buf, size_t buf_size, gex_AM_Arg_t buf_align_and_level,
                         gex_AM_Arg_t persona_ptr_lo, gex_AM_Arg_t persona_ptr_hi);
-
+  void am_long_master(gex_Token_t, void *buf, size_t buf_size,
+                      gex_AM_Arg_t cmd_size, gex_AM_Arg_t cmd_align,
+                      gex_AM_Arg_t cb_ptr_lo, gex_AM_Arg_t cb_ptr_hi,
+                      gex_AM_Arg_t persona_ptr_lo, gex_AM_Arg_t persona_ptr_hi,
+                      gex_AM_Arg_t c0, gex_AM_Arg_t c1, gex_AM_Arg_t c2, gex_AM_Arg_t c3, gex_AM_Arg_t c4,
+                      gex_AM_Arg_t c5, gex_AM_Arg_t c6, gex_AM_Arg_t c7, gex_AM_Arg_t c8, gex_AM_Arg_t c9);
+  void am_long_master_reply(gex_Token_t,
+                            gex_AM_Arg_t cb_ptr_lo, gex_AM_Arg_t cb_ptr_hi,
+                            gex_AM_Arg_t persona_ptr_lo, gex_AM_Arg_t persona_ptr_hi);
+
+  #define AM_ENTRY_OF(name, flags, arg_n) \
+    {id_##name, (void(*)())name, flags, arg_n, nullptr, #name}
   #define AM_ENTRY(name, arg_n) \
-    {id_##name, (void(*)())name, GEX_FLAG_AM_MEDIUM | GEX_FLAG_AM_REQUEST, arg_n, nullptr, #name}
+    AM_ENTRY_OF(name, GEX_FLAG_AM_MEDIUM | GEX_FLAG_AM_REQUEST, arg_n)
   
   gex_AM_Entry_t am_table[] = {
     AM_ENTRY(am_eager_restricted, 1),
     AM_ENTRY(am_eager_master, 1),
-    AM_ENTRY(am_eager_persona, 3)
+    AM_ENTRY(am_eager_persona, 3),
+    AM_ENTRY_OF(am_long_master, GEX_FLAG_AM_LONG | GEX_FLAG_AM_REQUEST, 16),
+    AM_ENTRY_OF(am_long_master_reply, GEX_FLAG_AM_SHORT | GEX_FLAG_AM_REPLY, 4)
   };
+  
+  // Splits a pointer over two gex_AM_Arg_t's, see am_eager_persona()
+  // for putting it back together.
+  gex_AM_Arg_t ptr_lo(void *p) {
+    return reinterpret_cast<intptr_t>(p) & 0xffffffffu;
+  }
+  gex_AM_Arg_t ptr_hi(void *p) {
+    return reinterpret_cast<intptr_t>(p) >> 31 >> 1;
+  }
+  void* ptr_join(gex_AM_Arg_t lo, gex_AM_Arg_t hi) {
+    return reinterpret_cast<void*>(
+      static_cast<intptr_t>(hi)<<31<<1 |
+      (lo & 0xffffffff)
+    );
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -114,6 +151,66 @@ namespace {
 namespace {
   std::mutex segment_lock_;
   mspace segment_mspace_;
+  
+  // Other ranks' segments mapped into our address space (PSHM), indexed
+  // by rank. Empty when gasnet maps none.
+  struct nbr_segment {
+    bool mapped;
+    intptr_t delta; // our address minus the owner's
+  };
+  vector<nbr_segment> nbr_segments_;
+  
+  // What progress() does once it finds itself idle.
+  enum class idle_policy { spin, yield, backoff };
+  idle_policy idle_policy_ = idle_policy::yield;
+  unsigned idle_sleep_max_us_ = 1000;
+  
+  // gasnet calls this thread made since it last left progress()
+  thread_local unsigned tl_injected_ = 0;
+  
+  // Whether a handle of ours (rput, rget, atomic) or the reply to one of
+  // our rpc's is still in flight.
+  bool ops_outstanding() {
+    bool any = false;
+    
+    #if UPCXX_BACKEND_GASNET_SEQ
+      any = !gasnet::master_hcbs.empty();
+    #endif
+    
+    detail::persona_foreach_active([&](persona &p) {
+      #if UPCXX_BACKEND_GASNET_PAR
+        any = any || !p.backend_state_.hcbs.empty();
+      #endif
+      any = any || p.backend_state_.rpc_replies_awaited != 0;
+    });
+    
+    return any;
+  }
+  
+  // Whether rpc's or lpc's runnable at `level` wait for this thread, ones
+  // that landed since progress_burst() last looked.
+  bool work_waiting(progress_level level) {
+    bool any = false;
+    
+    if(backend::master.active_with_caller()) {
+      any = !rpcs_internal_.empty() ||
+            (level == progress_level::user && !rpcs_user_.empty());
+    }
+    
+    detail::persona_foreach_active([&](persona &p) {
+      any = any || detail::persona_lpcs_waiting(p, level);
+    });
+    
+    return any;
+  }
+  
+  // Where `addr`, in the segment of `rank`, is mapped here. Null if we
+  // can't reach it by load/store.
+  void* nbr_segment_local(intrank_t rank, void *addr) {
+    if(nbr_segments_.empty() || !nbr_segments_[rank].mapped)
+      return nullptr;
+    return reinterpret_cast<char*>(addr) + nbr_segments_[rank].delta;
+  }
 }
   
 ////////////////////////////////////////////////////////////////////////
@@ -136,6 +233,19 @@ void upcxx::init() {
   UPCXX_ASSERT_ALWAYS(ok == GASNET_OK);
 
   size_t segment_size = size_t(os_env<double>("UPCXX_SEGMENT_MB", 128)*(1<<20));
+  
+  string idle = os_env<string>("UPCXX_PROGRESS_IDLE", "yield");
+  if(idle == "spin")
+    idle_policy_ = idle_policy::spin;
+  else if(idle == "backoff")
+    idle_policy_ = idle_policy::backoff;
+  else {
+    UPCXX_ASSERT_ALWAYS(idle == "yield",
+      "UPCXX_PROGRESS_IDLE must be one of spin, yield or backoff, not \""<<idle<<"\"."
+    );
+    idle_policy_ = idle_policy::yield;
+  }
+  idle_sleep_max_us_ = std::max(1u, os_env<unsigned>("UPCXX_PROGRESS_IDLE_MAX_US", 1000));
   // page size should always be a power of 2
   segment_size = (segment_size + GASNET_PAGESIZE-1) & -GASNET_PAGESIZE;
   // Do this instead? segment_size = gasnet_getMaxLocalSegmentSize();
@@ -168,6 +278,23 @@ void upcxx::init() {
     /*flags*/0,
     3
   );
+  
+  // Before anyone can send to us.
+  gasnet::am_size_medium_max = am_medium_size;
+  gasnet::am_size_long_max = gex_AM_MaxRequestLong(
+    gasnet::world_team,
+    GEX_RANK_INVALID,
+    GEX_EVENT_NOW,
+    /*flags*/0,
+    16
+  );
+  gasnet::am_size_fused_max = std::min(gasnet::am_size_long_max, size_t(64<<10));
+  gasnet::landing_init(am_medium_size);
+  
+  // Teams must exist before any rank can send collective traffic for them.
+  upcxx::world();
+  upcxx::local_team();
+  
   gasnet_barrier_notify(0, GASNET_BARRIERFLAG_ANONYMOUS);
   ok = gasnet_barrier_wait(0, GASNET_BARRIERFLAG_ANONYMOUS);
   UPCXX_ASSERT_ALWAYS(ok == GASNET_OK);
@@ -197,6 +324,25 @@ void upcxx::init() {
   
   segment_mspace_ = create_mspace_with_base(segment_base, segment_size, 1);
   mspace_set_footprint_limit(segment_mspace_, segment_size);
+  
+  #if GASNET_PSHM
+    nbr_segments_.assign(backend::rank_n, nbr_segment{false, 0});
+    
+    for(intrank_t r=0; r != backend::rank_n; r++) {
+      void *owner_base, *local_base = nullptr;
+      
+      ok = gex_Segment_QueryBound(
+        gasnet::world_team, r,
+        &owner_base, &local_base, nullptr
+      );
+      
+      if(ok == GASNET_OK && r != backend::rank_me && local_base != nullptr) {
+        nbr_segments_[r].mapped = true;
+        nbr_segments_[r].delta = reinterpret_cast<char*>(local_base)
+                               - reinterpret_cast<char*>(owner_base);
+      }
+    }
+  #endif
 }
 
 void upcxx::finalize() {
@@ -207,6 +353,8 @@ void upcxx::finalize() {
   
   upcxx::barrier();
   
+  detail::team_promises_drop_unfulfilled();
+  
   if(backend::initial_master_scope != nullptr)
     delete backend::initial_master_scope;
 }
@@ -229,6 +377,32 @@ void upcxx::barrier() {
     upcxx::progress();
 }
 
+future<> upcxx::barrier_async() {
+  UPCXX_ASSERT(backend::master.active_with_caller());
+  
+  // Completes through the handle queue like rput/rget, so the barrier
+  // advances with every progress() call instead of a dedicated spin.
+  struct barrier_cb final: gasnet::handle_cb {
+    upcxx::promise<> pro;
+    
+    void execute_and_delete(gasnet::handle_cb_successor) {
+      backend::during_user(std::move(pro));
+      delete this;
+    }
+  };
+  
+  barrier_cb *cb = new barrier_cb;
+  future<> ans = cb->pro.get_future();
+  
+  gex_Event_t h = gex_Coll_BarrierNB(gasnet::world_team, /*flags*/0);
+  cb->handle = reinterpret_cast<uintptr_t>(h);
+  
+  gasnet::register_cb(cb);
+  gasnet::after_gasnet();
+  
+  return ans;
+}
+
 void* upcxx::allocate(size_t size, size_t alignment) {
   #if UPCXX_BACKEND_GASNET_SEQ
     UPCXX_ASSERT(backend::master.active_with_caller());
@@ -312,6 +486,37 @@ void gasnet::send_am_eager_persona(
   after_gasnet();
 }
 
+void gasnet::rma_put_then_am_master(
+    intrank_t rank_d, void *buf_d,
+    const void *buf_s, std::size_t buf_size,
+    const void *cmd_buf,
+    std::size_t cmd_size, std::size_t cmd_align,
+    handle_cb *op_cb
+  ) {
+  
+  UPCXX_ASSERT(buf_size <= am_size_long_max && cmd_size <= am_long_cmd_max);
+  
+  UPCXX_STATS_ADD(rput_n, 1);
+  UPCXX_STATS_ADD(rput_bytes, buf_size);
+  
+  gex_AM_Arg_t c[am_long_cmd_max/sizeof(gex_AM_Arg_t)] = {};
+  std::memcpy(c, cmd_buf, cmd_size);
+  
+  void *per = &upcxx::current_persona();
+  
+  gex_AM_RequestLong16(
+    world_team, rank_d,
+    id_am_long_master, const_cast<void*>(buf_s), buf_size, buf_d,
+    GEX_EVENT_NOW, /*flags*/0,
+    cmd_size, cmd_align,
+    ptr_lo(op_cb), ptr_hi(op_cb),
+    ptr_lo(per), ptr_hi(per),
+    c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], c[8], c[9]
+  );
+  
+  after_gasnet();
+}
+
 namespace {
   template<typename Fn>
   struct rma_get_cb final: gasnet::handle_cb {
@@ -364,8 +569,21 @@ void gasnet::send_am_rdzv(
     rank_d,
     persona_d,
     [=]() {
-      // TODO: Elide rma_get (copy) for node-local sends with pointer
-      // translation and execution directly from source buffer.
+      void *buf_local = nbr_segment_local(rank_s, buf_s);
+      
+      if(buf_local != nullptr) {
+        // Source shares memory with us: execute straight out of its
+        // buffer, then tell it to free the buffer.
+        backend::during_level<level>([=]() {
+          parcel_reader r{buf_local};
+          command_execute(r) >> [=]() {
+            gasnet::send_am_restricted(rank_s,
+              [=]() { upcxx::deallocate(buf_s); }
+            );
+          };
+        });
+        return;
+      }
       
       void *buf_d = upcxx::allocate(buf_size, buf_align);
       UPCXX_ASSERT_ALWAYS(buf_d != nullptr, "Exhausted shared segment!");
@@ -395,6 +613,8 @@ template void gasnet::send_am_rdzv<progress_level::internal>(intrank_t, persona*
 template void gasnet::send_am_rdzv<progress_level::user>(intrank_t, persona*, void*, size_t, size_t);
 
 void gasnet::after_gasnet() {
+  tl_injected_ += 1;
+  
   if(detail::tl_progressing >= 0)
     return;
   detail::tl_progressing = (int)progress_level::internal;
@@ -408,7 +628,7 @@ void gasnet::after_gasnet() {
     
     if(have_master) {
       #if UPCXX_BACKEND_GASNET_SEQ
-        exec_n += gasnet::master_hcbs.burst(4);
+        exec_n += gasnet::master_hcbs.burst(gasnet::handle_cb_inject_burst_n);
       #endif
       
       detail::persona_as_top(backend::master, [&]() {
@@ -418,7 +638,7 @@ void gasnet::after_gasnet() {
     
     detail::persona_foreach_active([&](persona &p) {
       #if UPCXX_BACKEND_GASNET_PAR
-        exec_n += p.backend_state_.hcbs.burst(4);
+        exec_n += p.backend_state_.hcbs.burst(gasnet::handle_cb_inject_burst_n);
       #endif
       exec_n += detail::persona_burst(p, progress_level::internal);
     });
@@ -434,9 +654,9 @@ void gasnet::after_gasnet() {
 ////////////////////////////////////////////////////////////////////////
 // from: upcxx/backend.hpp
 
-void upcxx::progress(progress_level level) {
+int gasnet::progress_burst(progress_level level) {
   if(detail::tl_progressing >= 0)
-    return;
+    return 0;
   detail::tl_progressing = (int)level;
   
   bool have_master = backend::master.active_with_caller();
@@ -450,7 +670,7 @@ void upcxx::progress(progress_level level) {
     
     if(have_master) {
       #if UPCXX_BACKEND_GASNET_SEQ
-        exec_n += gasnet::master_hcbs.burst(4);
+        exec_n += gasnet::master_hcbs.burst(gasnet::handle_cb_burst_n);
       #endif
       
       detail::persona_as_top(backend::master, [&]() {
@@ -462,7 +682,7 @@ void upcxx::progress(progress_level level) {
     
     detail::persona_foreach_active([&](persona &p) {
       #if UPCXX_BACKEND_GASNET_PAR
-        exec_n += p.backend_state_.hcbs.burst(4);
+        exec_n += p.backend_state_.hcbs.burst(gasnet::handle_cb_burst_n);
       #endif
       exec_n += detail::persona_burst(p, level);
     });
@@ -472,26 +692,56 @@ void upcxx::progress(progress_level level) {
   // Try really hard to do stuff before leaving attentiveness.
   while(total_exec_n < 1000 && exec_n != 0);
   
-  /* In SMP tests we typically oversubscribe ranks to cpus. This is
-   * an attempt at heuristically determining if this rank is just
-   * spinning fruitlessly hogging the cpu from another who needs it.
-   * It would be a lot more effective if we included knowledge of
-   * whether outgoing communication was generated between progress
-   * calls, then we would really know that we're just idle. Well,
-   * almost. There would still exist the case where this rank is
-   * receiving nothing, sending nothing, but is loaded with compute
-   * and is only periodically progressing to be "nice".
+  if(detail::tl_rpc_aggregators != nullptr)
+    detail::rpc_aggregators_progress();
+  
+  detail::tl_progressing = -1;
+  
+  return total_exec_n;
+}
+
+void upcxx::progress(progress_level level) {
+  if(detail::tl_progressing >= 0)
+    return;
+  
+  int total_exec_n = gasnet::progress_burst(level);
+  
+  UPCXX_STATS_ADD(progress_n, 1);
+  UPCXX_STATS_ADD(progress_empty_n, total_exec_n == 0 ? 1 : 0);
+  
+  /* In SMP tests we typically oversubscribe ranks to cpus, there an idle
+   * rank spinning in progress takes the cpu from another who needs it.
+   * On dedicated cores giving the cpu up only adds latency. We count a
+   * call as idle if it ran nothing, nothing was injected since the
+   * previous one, and no rpc or lpc we could run has landed meanwhile
+   * (the burst stops on its first empty pass, other threads may have
+   * queued some since). Every 10th consecutive idle call does what
+   * UPCXX_PROGRESS_IDLE asks: nothing (spin), sched_yield (yield,
+   * default), or sleep for a time doubling from 1us up to
+   * UPCXX_PROGRESS_IDLE_MAX_US (backoff). Backoff only yields while one
+   * of our handles or rpc replies is outstanding, so a wait() on either
+   * isn't put to sleep.
    */
   thread_local int consecutive_nothings = 0;
+  thread_local unsigned sleep_us = 1;
+  
+  bool idle = total_exec_n == 0 && tl_injected_ == 0 && !work_waiting(level);
+  tl_injected_ = 0;
   
-  if(total_exec_n != 0)
+  if(!idle || idle_policy_ == idle_policy::spin) {
     consecutive_nothings = 0;
+    sleep_us = 1;
+  }
   else if(++consecutive_nothings == 10) {
-    sched_yield();
     consecutive_nothings = 0;
+    
+    if(idle_policy_ == idle_policy::yield || ops_outstanding())
+      sched_yield();
+    else {
+      usleep(sleep_us);
+      sleep_us = std::min(2*sleep_us, idle_sleep_max_us_);
+    }
   }
-  
-  detail::tl_progressing = -1;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -511,16 +761,15 @@ namespace {
       buf_done = command_execute(r);
     }
     else {
-      void *tmp;
-      int ok = posix_memalign(&tmp, buf_align, buf_size);
-      UPCXX_ASSERT_ALWAYS(ok == 0);
+      int cls;
+      void *tmp = gasnet::landing_allocate(buf_size, buf_align, cls);
       
       std::memcpy((void**)tmp, (void**)buf, buf_size);
       
       parcel_reader r{tmp};
       buf_done = command_execute(r);
       
-      std::free(tmp);
+      gasnet::landing_deallocate(tmp, cls);
     }
     
     UPCXX_ASSERT(buf_done.ready());
@@ -596,4 +845,54 @@ namespace {
       inbox.enqueue(m);
     }
   }
+  
+  void am_long_master(
+      gex_Token_t token,
+      void *buf, size_t buf_size,
+      gex_AM_Arg_t cmd_size, gex_AM_Arg_t cmd_align,
+      gex_AM_Arg_t cb_lo, gex_AM_Arg_t cb_hi,
+      gex_AM_Arg_t per_lo, gex_AM_Arg_t per_hi,
+      gex_AM_Arg_t c0, gex_AM_Arg_t c1, gex_AM_Arg_t c2, gex_AM_Arg_t c3, gex_AM_Arg_t c4,
+      gex_AM_Arg_t c5, gex_AM_Arg_t c6, gex_AM_Arg_t c7, gex_AM_Arg_t c8, gex_AM_Arg_t c9
+    ) {
+    
+    UPCXX_ASSERT(backend::rank_n!=-1);
+    
+    // The payload is already in place, gasnet runs long handlers after
+    // it landed.
+    gex_AM_Arg_t c[] = {c0, c1, c2, c3, c4, c5, c6, c7, c8, c9};
+    rpc_message *m = rpc_message::build_copy(c, cmd_size, cmd_align);
+    
+    if(UPCXX_BACKEND_GASNET_PAR && !backend::master.active_with_caller()) {
+      detail::persona_defer(
+        backend::master, progress_level::user,
+        [=]() {
+          m->execute_and_delete();
+        }
+      );
+    }
+    else
+      rpcs_user_.enqueue(m);
+    
+    gex_AM_ReplyShort4(
+      token, id_am_long_master_reply, /*flags*/0,
+      cb_lo, cb_hi, per_lo, per_hi
+    );
+  }
+  
+  void am_long_master_reply(
+      gex_Token_t,
+      gex_AM_Arg_t cb_lo, gex_AM_Arg_t cb_hi,
+      gex_AM_Arg_t per_lo, gex_AM_Arg_t per_hi
+    ) {
+    
+    gasnet::handle_cb *cb = static_cast<gasnet::handle_cb*>(ptr_join(cb_lo, cb_hi));
+    persona *per = static_cast<persona*>(ptr_join(per_lo, per_hi));
+    
+    detail::persona_defer(*per, progress_level::internal,
+      [=]() {
+        cb->execute_and_delete(gasnet::handle_cb_successor{nullptr, nullptr});
+      }
+    );
+  }
 }
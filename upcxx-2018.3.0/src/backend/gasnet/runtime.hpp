@@ -5,6 +5,7 @@
 #include <upcxx/command.hpp>
 
 #include <upcxx/backend/gasnet/handle_cb.hpp>
+#include <upcxx/stats.hpp>
 
 #include <cstdint>
 #include <cstdlib>
@@ -22,12 +23,27 @@ namespace upcxx {
 namespace backend {
 namespace gasnet {
   extern std::size_t am_size_rdzv_cutover;
+  // Largest buffer send_am_eager_* take.
+  extern std::size_t am_size_medium_max;
+  // Largest payload of rma_put_then_am_master.
+  extern std::size_t am_size_long_max;
+  // Largest rput we fuse with its remote completion. Past this the
+  // transfer dwarfs the round trip a separate rpc costs, and conduits
+  // whose AM long limit runs to gigabytes shouldn't see one that big.
+  extern std::size_t am_size_fused_max;
+  // Largest command rma_put_then_am_master takes, it rides in ten
+  // 32-bit AM arguments.
+  constexpr std::size_t am_long_cmd_max = 10*4;
 
   #if UPCXX_BACKEND_GASNET_SEQ
     extern handle_cb_queue master_hcbs;
   #endif
   
   void after_gasnet();
+  
+  // The work of upcxx::progress(level) without its idling, returns how
+  // many callbacks ran. Does nothing when called from within progress.
+  int progress_burst(progress_level level);
 
   // Register a handle callback for the current persona
   void register_cb(handle_cb *cb);
@@ -61,6 +77,19 @@ namespace gasnet {
     std::size_t buf_align
   );
   
+  // One AM long which lands `buf_size` bytes of `buf_s` at `buf_d` on
+  // `rank_d` and then has the master there execute the packed command
+  // during user progress. `buf_s` may be reused on return. The
+  // receiver's reply has the calling persona run
+  // `op_cb->execute_and_delete()`, which must not add successors.
+  void rma_put_then_am_master(
+    intrank_t rank_d, void *buf_d,
+    const void *buf_s, std::size_t buf_size,
+    const void *command_buf,
+    std::size_t cmd_size, std::size_t cmd_align,
+    handle_cb *op_cb
+  );
+  
   // Send AM (packed command) via rendezvous, receiver executes druing `level`.
   template<progress_level level>
   void send_am_rdzv(
@@ -127,11 +156,16 @@ namespace backend {
     command_pack(w, ub.size(), fn);
     
     if(eager) {
+      UPCXX_STATS_ADD(am_eager_n, 1);
+      UPCXX_STATS_ADD(am_eager_bytes, w.size());
       gasnet::send_am_eager_master(level, recipient, buf, w.size(), w.alignment());
       std::free(buf);
     }
-    else
+    else {
+      UPCXX_STATS_ADD(am_rdzv_n, 1);
+      UPCXX_STATS_ADD(am_rdzv_bytes, w.size());
       gasnet::send_am_rdzv<level>(recipient, /*master*/nullptr, buf, w.size(), w.alignment());
+    }
   }
   
   template<upcxx::progress_level level, typename Fn>
@@ -159,11 +193,16 @@ namespace backend {
     command_pack(w, ub.size(), fn);
     
     if(eager) {
+      UPCXX_STATS_ADD(am_eager_n, 1);
+      UPCXX_STATS_ADD(am_eager_bytes, w.size());
       gasnet::send_am_eager_persona(level, recipient_rank, recipient_persona, buf, w.size(), w.alignment());
       std::free(buf);
     }
-    else
+    else {
+      UPCXX_STATS_ADD(am_rdzv_n, 1);
+      UPCXX_STATS_ADD(am_rdzv_bytes, w.size());
       gasnet::send_am_rdzv<level>(recipient_rank, recipient_persona, buf, w.size(), w.alignment());
+    }
   }
   
   //////////////////////////////////////////////////////////////////////
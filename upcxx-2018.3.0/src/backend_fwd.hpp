@@ -66,13 +66,16 @@ namespace backend {
     struct persona_state {
       // personas carry their list of oustanding gasnet handles
       gasnet::handle_cb_queue hcbs;
+      // rpc's initiated by this persona still waiting on their reply
+      int rpc_replies_awaited = 0;
     };
   }}
 #else
   namespace upcxx {
   namespace backend {
     struct persona_state {
-      // personas carry no extra state
+      // rpc's initiated by this persona still waiting on their reply
+      int rpc_replies_awaited = 0;
     };
   }}
 #endif
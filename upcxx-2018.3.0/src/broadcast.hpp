@@ -13,12 +13,14 @@ namespace upcxx {
     template<typename T>
     void broadcast_receive(
         T const &value,
-        intrank_t rank_ub, // in range [0, 2*rank_n-1)
+        intrank_t rank_ub, // team rank in range [0, 2*rank_n-1)
+        team &tm,
         dist_id<promise<T>> id
       ) {
       
-      intrank_t rank_me = upcxx::rank_me();
-      intrank_t rank_n = upcxx::rank_n();
+      intrank_t rank_me = tm.rank_me();
+      intrank_t rank_n = tm.rank_n();
+      team_id tm_id = tm.id();
       
       // Send to top-half of [rank_me,peer_ub), then set interval to
       // lower-half and repeat.
@@ -35,9 +37,14 @@ namespace upcxx {
         intrank_t sub_lb = mid - translate;
         intrank_t sub_ub = rank_ub - translate;
         
-        rpc_ff(sub_lb,
+        rpc_ff(tm[sub_lb],
           [=](T const &value) {
-            broadcast_receive(value, sub_ub, id);
+            // the receiver may still be constructing the team
+            tm_id.when_here().then(
+              [=](team &tm) {
+                broadcast_receive(value, sub_ub, tm, id);
+              }
+            );
           },
           value
         );
@@ -53,18 +60,19 @@ namespace upcxx {
     }
   }
   
+  // Collective over `tm`, `root` is a rank in `tm`.
   template<typename T1,
            typename T = typename std::decay<T1>::type>
   future<T> broadcast(
-      T1 &&value, intrank_t root
+      T1 &&value, intrank_t root, team &tm = upcxx::world()
     ) {
-    intrank_t rank_n = upcxx::rank_n();
-    intrank_t rank_me = upcxx::rank_me();
+    intrank_t rank_n = tm.rank_n();
+    intrank_t rank_me = tm.rank_me();
     
-    dist_object<promise<T>> *state = new dist_object<promise<T>>({});
+    dist_object<promise<T>> *state = new dist_object<promise<T>>({}, tm);
     
     if(rank_me == root)
-      detail::broadcast_receive(value, root + rank_n, state->id());
+      detail::broadcast_receive(value, root + rank_n, tm, state->id());
     
     future<T> ans = (*state)->get_future();
     
@@ -0,0 +1,281 @@
+#ifndef _e369f874_f12c_4d33_a6c7_28766237e7be
+#define _e369f874_f12c_4d33_a6c7_28766237e7be
+
+#include <upcxx/backend.hpp>
+#include <upcxx/dist_object.hpp>
+#include <upcxx/packing.hpp>
+#include <upcxx/rpc.hpp>
+#include <upcxx/team.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace upcxx {
+  // Collective over `tm`, `root` is a rank in `tm`. Copies the `n`
+  // elements at `buf` on `root` to the `n` elements at `buf` on every
+  // other member. `n` must agree across members and `buf` may not be
+  // touched until the future is ready.
+  template<typename T>
+  future<> broadcast(
+    T *buf, std::size_t n, intrank_t root,
+    team &tm = upcxx::world()
+  );
+  
+  namespace detail {
+    // Payloads of at least this many bytes (and one element per rank)
+    // use scatter + allgather, smaller ones the pipelined tree.
+    constexpr std::size_t broadcast_bulk_sag_bytes = 1<<20;
+    // Chunk size of the pipelined tree.
+    constexpr std::size_t broadcast_bulk_chunk_bytes = 64<<10;
+    
+    ////////////////////////////////////////////////////////////////////
+    // Pipelined tree: the binomial tree of broadcast(T) run once per
+    // chunk, so a rank forwards a chunk as soon as it has it instead of
+    // waiting on the whole payload.
+    
+    template<typename T>
+    struct broadcast_tree_state {
+      team *tm;
+      T *buf;
+      std::size_t n, chunk_n;
+      // chunks not yet here
+      std::size_t chunks_left;
+      promise<> done;
+      
+      std::size_t chunk_lo(std::size_t c) const { return c*chunk_n; }
+      std::size_t chunk_size(std::size_t c) const {
+        return std::min(chunk_n, n - chunk_lo(c));
+      }
+      
+      // Called once chunk `c` is in `buf`, forwards it to the rest of
+      // [rank_me,rank_ub) (taken modulo rank_n). Deletes `this_obj` once
+      // every chunk got here.
+      void received(
+        dist_object<broadcast_tree_state> &this_obj,
+        std::size_t c,
+        intrank_t rank_ub
+      );
+    };
+    
+    ////////////////////////////////////////////////////////////////////
+    // van de Geijn: binomial scatter of one block per rank, then a ring
+    // allgather of the blocks. The root sends each element once instead
+    // of log(rank_n) times. Block b belongs to the rank b places after
+    // the root.
+    
+    template<typename T>
+    struct broadcast_sag_state {
+      team *tm;
+      T *buf;
+      std::size_t n;
+      intrank_t root;
+      promise<> done;
+      
+      // Step 0 is the scatter, steps [1,rank_n) the ring.
+      int step;
+      bool sent;
+      // our blocks [rel,scatter_ub) of the scatter, if they came early
+      std::unique_ptr<std::vector<T>> scattered;
+      intrank_t scatter_ub;
+      // inbox[s]: block received in ring step s, may arrive steps early
+      std::vector<std::unique_ptr<std::vector<T>>> inbox;
+      
+      std::size_t block_lo(intrank_t b) const { return n*b/tm->rank_n(); }
+      
+      // Runs steps until one is missing its payload. Deletes `this_obj`
+      // once done.
+      void advance(dist_object<broadcast_sag_state> &this_obj);
+    };
+    
+    template<typename T>
+    future<> broadcast_tree(T *buf, std::size_t n, intrank_t root, team &tm) {
+      std::size_t chunk_n = std::max<std::size_t>(1, broadcast_bulk_chunk_bytes/sizeof(T));
+      std::size_t chunks = std::max<std::size_t>(1, (n + chunk_n-1)/chunk_n);
+      
+      auto *state = new dist_object<broadcast_tree_state<T>>(
+        broadcast_tree_state<T>{&tm, buf, n, chunk_n, chunks, promise<>{}},
+        tm
+      );
+      
+      future<> result = (*state)->done.get_future();
+      
+      // The last of these deletes `state` on the root.
+      if(tm.rank_me() == root) {
+        for(std::size_t c=0; c != chunks; c++)
+          (*state)->received(*state, c, root + tm.rank_n());
+      }
+      
+      return result;
+    }
+    
+    template<typename T>
+    void broadcast_tree_state<T>::received(
+        dist_object<broadcast_tree_state> &this_obj,
+        std::size_t c,
+        intrank_t rank_ub
+      ) {
+      
+      intrank_t rank_me = this->tm->rank_me();
+      intrank_t rank_n = this->tm->rank_n();
+      
+      // Same interval halving as broadcast_receive().
+      while(true) {
+        intrank_t mid = rank_me + (rank_ub-rank_me)/2;
+        
+        if(mid == rank_me)
+          break;
+        
+        intrank_t translate = rank_n <= mid ? rank_n : 0;
+        
+        rpc_ff((*this->tm)[mid - translate],
+          [](dist_object<broadcast_tree_state> &this_obj,
+             std::size_t c, intrank_t rank_ub, trivial_chunk<T> const &chunk) {
+            std::copy(
+              chunk.elts.begin(), chunk.elts.end(),
+              this_obj->buf + this_obj->chunk_lo(c)
+            );
+            this_obj->received(this_obj, c, rank_ub);
+          },
+          this_obj, c, rank_ub - translate,
+          trivial_chunk<T>{this->buf + this->chunk_lo(c), this->chunk_size(c), {}}
+        );
+        
+        rank_ub = mid;
+      }
+      
+      if(0 == --this->chunks_left) {
+        this->done.fulfill_result();
+        delete &this_obj;
+      }
+    }
+    
+    template<typename T>
+    future<> broadcast_sag(T *buf, std::size_t n, intrank_t root, team &tm) {
+      auto *state = new dist_object<broadcast_sag_state<T>>(
+        broadcast_sag_state<T>{
+          &tm, buf, n, root,
+          promise<>{},
+          /*step=*/0,
+          /*sent=*/false,
+          std::unique_ptr<std::vector<T>>{},
+          /*scatter_ub=*/tm.rank_n(),
+          std::vector<std::unique_ptr<std::vector<T>>>(tm.rank_n())
+        },
+        tm
+      );
+      
+      future<> result = (*state)->done.get_future();
+      
+      // This could delete `state` before it returns.
+      (*state)->advance(*state);
+      
+      return result;
+    }
+    
+    template<typename T>
+    void broadcast_sag_state<T>::advance(
+        dist_object<broadcast_sag_state> &this_obj
+      ) {
+      intrank_t rank_n = this->tm->rank_n();
+      // our position relative to the root
+      intrank_t rel = (this->tm->rank_me() - this->root + rank_n) % rank_n;
+      
+      while(true) {
+        if(this->step == 0) {
+          if(rel != 0) {
+            if(!this->scattered)
+              return; // resumed by the rpc delivering it
+            std::copy(
+              this->scattered->begin(), this->scattered->end(),
+              this->buf + this->block_lo(rel)
+            );
+            this->scattered.reset();
+          }
+          
+          // Hand the top half of our blocks to the rank owning its first
+          // block, then repeat on the bottom half.
+          intrank_t rank_ub = this->scatter_ub;
+          while(true) {
+            intrank_t mid = rel + (rank_ub-rel)/2;
+            
+            if(mid == rel)
+              break;
+            
+            rpc_ff((*this->tm)[(mid + this->root) % rank_n],
+              [](dist_object<broadcast_sag_state> &this_obj,
+                 intrank_t rank_ub, trivial_chunk<T> const &chunk) {
+                this_obj->scattered.reset(new std::vector<T>(std::move(chunk.elts)));
+                this_obj->scatter_ub = rank_ub;
+                this_obj->advance(this_obj);
+              },
+              this_obj, rank_ub,
+              trivial_chunk<T>{
+                this->buf + this->block_lo(mid),
+                this->block_lo(rank_ub) - this->block_lo(mid),
+                {}
+              }
+            );
+            
+            rank_ub = mid;
+          }
+        }
+        else if(this->step < rank_n) {
+          // Pass the block we got last step on to our successor, take
+          // the one before it from our predecessor.
+          intrank_t k = this->step - 1;
+          
+          if(!this->sent) {
+            intrank_t b = (rel - k + rank_n) % rank_n;
+            
+            rpc_ff((*this->tm)[(this->tm->rank_me() + 1) % rank_n],
+              [](dist_object<broadcast_sag_state> &this_obj,
+                 int step, trivial_chunk<T> const &chunk) {
+                this_obj->inbox[step].reset(new std::vector<T>(std::move(chunk.elts)));
+                this_obj->advance(this_obj);
+              },
+              this_obj, this->step,
+              trivial_chunk<T>{
+                this->buf + this->block_lo(b),
+                this->block_lo(b+1) - this->block_lo(b),
+                {}
+              }
+            );
+            this->sent = true;
+          }
+          
+          std::unique_ptr<std::vector<T>> &in = this->inbox[this->step];
+          if(!in)
+            return;
+          
+          intrank_t b = (rel - k - 1 + rank_n) % rank_n;
+          std::copy(in->begin(), in->end(), this->buf + this->block_lo(b));
+          in.reset();
+        }
+        else {
+          this->done.fulfill_result();
+          delete &this_obj;
+          return;
+        }
+        
+        this->step += 1;
+        this->sent = false;
+      }
+    }
+  }
+  
+  template<typename T>
+  future<> broadcast(
+      T *buf, std::size_t n, intrank_t root,
+      team &tm
+    ) {
+    std::size_t rank_n = tm.rank_n();
+    
+    if(1 < rank_n && rank_n <= n &&
+       detail::broadcast_bulk_sag_bytes <= n*sizeof(T))
+      return detail::broadcast_sag(buf, n, root, tm);
+    else
+      return detail::broadcast_tree(buf, n, root, tm);
+  }
+}
+#endif
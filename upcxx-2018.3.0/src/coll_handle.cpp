@@ -0,0 +1,48 @@
+#include <upcxx/coll_handle.hpp>
+#include <upcxx/dist_object.hpp>
+
+using upcxx::intrank_t;
+using upcxx::team;
+
+using namespace std;
+
+upcxx::detail::coll_tree upcxx::detail::coll_tree_make(
+    team &tm, intrank_t root, void *obj
+  ) {
+  
+  intrank_t rank_n = tm.rank_n();
+  // tree is built over ranks relative to the root
+  intrank_t rel = (tm.rank_me() - root + rank_n) % rank_n;
+  
+  dist_object<uintptr_t> objs(reinterpret_cast<uintptr_t>(obj), tm);
+  
+  coll_tree tree;
+  future<uintptr_t> parent_obj = upcxx::make_future(uintptr_t(0));
+  vector<future<uintptr_t>> child_objs;
+  
+  tree.parent = -1;
+  if(rel != 0) {
+    // same parent function as allreduce()
+    intrank_t parent = ((rel & (rel-1)) + root) % rank_n;
+    tree.parent = tm[parent];
+    parent_obj = objs.fetch(parent);
+  }
+  
+  for(int k=0; ; k++) {
+    intrank_t child = rel | (intrank_t(1)<<k);
+    if(child == rel || rank_n <= child)
+      break;
+    child = (child + root) % rank_n;
+    tree.children.push_back(tm[child]);
+    child_objs.push_back(objs.fetch(child));
+  }
+  
+  tree.parent_obj = parent_obj.wait();
+  for(auto &f: child_objs)
+    tree.child_objs.push_back(f.wait());
+  
+  // `objs` has to outlive everyone's fetches from it.
+  upcxx::barrier(tm);
+  
+  return tree;
+}
@@ -0,0 +1,347 @@
+#ifndef _47caa5ab_e737_412f_a2e9_97d0628e43f1
+#define _47caa5ab_e737_412f_a2e9_97d0628e43f1
+
+#include <upcxx/backend.hpp>
+#include <upcxx/packing.hpp>
+#include <upcxx/rpc.hpp>
+#include <upcxx/team.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/* Persistent collectives: the tree and the per-call state are set up
+ * once by the handle's constructor, after which a call only costs its
+ * messages. Messages name the receiver's instance by its address (learnt
+ * at construction) and the call by its sequence number, which picks one
+ * of `depth` preallocated slots. No dist_object, digest or hash lookup
+ * is involved past construction.
+ */
+
+namespace upcxx {
+  namespace detail {
+    // This rank's neighbours (world ranks) in the binomial tree of a
+    // persistent collective, and the address of their instance.
+    struct coll_tree {
+      intrank_t parent; // -1 at the root
+      std::uintptr_t parent_obj;
+      std::vector<intrank_t> children;
+      std::vector<std::uintptr_t> child_objs;
+    };
+    
+    // Collective over `tm`. Tree rooted at team rank `root`, `obj` is this
+    // rank's instance.
+    coll_tree coll_tree_make(team &tm, intrank_t root, void *obj);
+    
+    template<typename T, typename Op>
+    struct allreduce_handle_impl {
+      struct slot {
+        // contributions still missing, ours included
+        std::size_t incoming;
+        bool full; // accum constructed
+        bool called; // answer constructed
+        raw_storage<T> accum;
+        raw_storage<promise<T>> answer;
+      };
+      
+      coll_tree tree;
+      Op op;
+      std::vector<slot> slots;
+      std::uint64_t seq_n; // calls made
+      
+      slot& slot_of(std::uint64_t seq) { return slots[seq % slots.size()]; }
+      
+      void contribute(std::uint64_t seq, T const &value);
+      void finish(std::uint64_t seq, T const &value);
+    };
+    
+    template<typename T>
+    struct broadcast_handle_impl {
+      struct slot {
+        // The call this slot serves, older ones are done with it.
+        std::uint64_t next;
+        // Subtree members, us included, yet to be done with the call.
+        std::size_t unacked;
+        bool arrived; // value constructed
+        bool called; // answer constructed
+        raw_storage<T> value;
+        raw_storage<promise<T>> answer;
+      };
+      
+      coll_tree tree;
+      std::vector<slot> slots;
+      std::uint64_t seq_n; // calls made
+      
+      slot& slot_of(std::uint64_t seq) { return slots[seq % slots.size()]; }
+      
+      void forward(std::uint64_t seq, T const &value);
+      void arrive(std::uint64_t seq, T const &value);
+      // Our call `seq` is over, moves its slot on to seq + depth.
+      void retire(slot &s);
+      // One more subtree member is done with `seq`. Once all are the
+      // parent hears of it, or at the root the call completes.
+      void ack(std::uint64_t seq);
+    };
+  }
+  
+  // Reusable allreduce of T values over a fixed team and operation.
+  template<typename T, typename BinaryOp>
+  class allreduce_handle {
+    std::unique_ptr<detail::allreduce_handle_impl<T,BinaryOp>> impl_;
+  
+  public:
+    // Collective over `tm`. At most `depth` calls may be in flight on
+    // a rank. Every member must be done with its calls before any member
+    // destroys the handle.
+    allreduce_handle(BinaryOp op, team &tm = upcxx::world(), int depth = 4);
+    
+    // Collective over the handle's team, members call in the same order.
+    future<T> operator()(T value);
+  };
+  
+  // Reusable broadcast of T values from a fixed root over a fixed team.
+  template<typename T>
+  class broadcast_handle {
+    std::unique_ptr<detail::broadcast_handle_impl<T>> impl_;
+  
+  public:
+    // Collective over `tm`, `root` is a rank in `tm`. At most `depth`
+    // calls may be in flight on a rank. On the root a call is in flight
+    // until every member is done with it, so the root can't run more
+    // than `depth` calls ahead of anyone. Every member must be done with
+    // its calls before any member destroys the handle.
+    broadcast_handle(intrank_t root, team &tm = upcxx::world(), int depth = 4);
+    
+    // Collective over the handle's team, members call in the same order.
+    // `value` is only read on the root.
+    future<T> operator()(T value);
+  };
+  
+  //////////////////////////////////////////////////////////////////////
+  // allreduce_handle implementation
+  
+  template<typename T, typename BinaryOp>
+  allreduce_handle<T,BinaryOp>::allreduce_handle(BinaryOp op, team &tm, int depth):
+    impl_{new detail::allreduce_handle_impl<T,BinaryOp>{
+      detail::coll_tree{}, std::move(op), {}, /*seq_n=*/0
+    }} {
+    
+    UPCXX_ASSERT(depth > 0);
+    impl_->tree = detail::coll_tree_make(tm, 0, impl_.get());
+    
+    typename detail::allreduce_handle_impl<T,BinaryOp>::slot empty;
+    empty.incoming = impl_->tree.children.size() + 1;
+    empty.full = false;
+    empty.called = false;
+    impl_->slots.assign(depth, empty);
+  }
+  
+  template<typename T, typename BinaryOp>
+  future<T> allreduce_handle<T,BinaryOp>::operator()(T value) {
+    std::uint64_t seq = impl_->seq_n++;
+    auto &s = impl_->slot_of(seq);
+    
+    UPCXX_ASSERT_ALWAYS(!s.called, "More than `depth` calls in flight on allreduce_handle.");
+    
+    ::new(&s.answer.value) promise<T>;
+    s.called = true;
+    future<T> ans = s.answer.value.get_future();
+    
+    // Could complete the call before it returns.
+    impl_->contribute(seq, value);
+    
+    return ans;
+  }
+  
+  namespace detail {
+    template<typename T, typename Op>
+    void allreduce_handle_impl<T,Op>::contribute(
+        std::uint64_t seq, T const &value
+      ) {
+      slot &s = this->slot_of(seq);
+      
+      if(!s.full) {
+        ::new(&s.accum.value) T(value);
+        s.full = true;
+      }
+      else
+        s.accum.value = this->op(s.accum.value, value);
+      
+      if(0 == --s.incoming) {
+        if(this->tree.parent == -1) {
+          T result = std::move(s.accum.value);
+          this->finish(seq, result);
+        }
+        else {
+          rpc_ff(this->tree.parent,
+            [](std::uintptr_t obj, std::uint64_t seq, T const &value) {
+              reinterpret_cast<allreduce_handle_impl*>(obj)->contribute(seq, value);
+            },
+            this->tree.parent_obj, seq, s.accum.value
+          );
+        }
+      }
+    }
+    
+    template<typename T, typename Op>
+    void allreduce_handle_impl<T,Op>::finish(
+        std::uint64_t seq, T const &value
+      ) {
+      // The result goes back down the reduction tree, so a parent always
+      // frees a slot before its children can reuse it for seq + depth.
+      for(std::size_t i=0; i != this->tree.children.size(); i++) {
+        rpc_ff(this->tree.children[i],
+          [](std::uintptr_t obj, std::uint64_t seq, T const &value) {
+            reinterpret_cast<allreduce_handle_impl*>(obj)->finish(seq, value);
+          },
+          this->tree.child_objs[i], seq, value
+        );
+      }
+      
+      slot &s = this->slot_of(seq);
+      s.accum.value.~T();
+      s.full = false;
+      s.incoming = this->tree.children.size() + 1;
+      
+      promise<T> answer = std::move(s.answer.value);
+      s.answer.value.~promise<T>();
+      s.called = false;
+      
+      // Last, its callbacks may start the next call.
+      answer.fulfill_result(value);
+    }
+  }
+  
+  //////////////////////////////////////////////////////////////////////
+  // broadcast_handle implementation
+  
+  template<typename T>
+  broadcast_handle<T>::broadcast_handle(intrank_t root, team &tm, int depth):
+    impl_{new detail::broadcast_handle_impl<T>()} {
+    
+    UPCXX_ASSERT(depth > 0);
+    impl_->tree = detail::coll_tree_make(tm, root, impl_.get());
+    
+    typename detail::broadcast_handle_impl<T>::slot empty;
+    empty.unacked = impl_->tree.children.size() + 1;
+    empty.arrived = false;
+    empty.called = false;
+    impl_->slots.assign(depth, empty);
+    for(int i=0; i != depth; i++)
+      impl_->slots[i].next = i;
+  }
+  
+  template<typename T>
+  future<T> broadcast_handle<T>::operator()(T value) {
+    std::uint64_t seq = impl_->seq_n++;
+    auto &s = impl_->slot_of(seq);
+    
+    UPCXX_ASSERT_ALWAYS(s.next == seq, "More than `depth` calls in flight on broadcast_handle.");
+    
+    if(impl_->tree.parent == -1) {
+      impl_->forward(seq, value);
+      
+      ::new(&s.value.value) T(std::move(value));
+      s.arrived = true;
+      ::new(&s.answer.value) promise<T>;
+      s.called = true;
+      future<T> ans = s.answer.value.get_future();
+      
+      // Could complete the call before it returns.
+      impl_->ack(seq);
+      
+      return ans;
+    }
+    
+    if(s.arrived) {
+      T ans = std::move(s.value.value);
+      s.value.value.~T();
+      s.arrived = false;
+      impl_->retire(s);
+      return make_future<T>(std::move(ans));
+    }
+    
+    ::new(&s.answer.value) promise<T>;
+    s.called = true;
+    return s.answer.value.get_future();
+  }
+  
+  namespace detail {
+    template<typename T>
+    void broadcast_handle_impl<T>::forward(std::uint64_t seq, T const &value) {
+      for(std::size_t i=0; i != this->tree.children.size(); i++) {
+        rpc_ff(this->tree.children[i],
+          [](std::uintptr_t obj, std::uint64_t seq, T const &value) {
+            reinterpret_cast<broadcast_handle_impl*>(obj)->arrive(seq, value);
+          },
+          this->tree.child_objs[i], seq, value
+        );
+      }
+    }
+    
+    template<typename T>
+    void broadcast_handle_impl<T>::arrive(std::uint64_t seq, T const &value) {
+      slot &s = this->slot_of(seq);
+      
+      // The root sends `seq` only once everyone is done with seq - depth,
+      // so however rpc_ff's get reordered the slot is already ours.
+      UPCXX_ASSERT(s.next == seq);
+      
+      this->forward(seq, value);
+      
+      if(s.called) {
+        promise<T> answer = std::move(s.answer.value);
+        s.answer.value.~promise<T>();
+        s.called = false;
+        this->retire(s);
+        answer.fulfill_result(value);
+      }
+      else {
+        ::new(&s.value.value) T(value);
+        s.arrived = true;
+      }
+    }
+    
+    template<typename T>
+    void broadcast_handle_impl<T>::retire(slot &s) {
+      std::uint64_t seq = s.next;
+      s.next += this->slots.size();
+      this->ack(seq);
+    }
+    
+    template<typename T>
+    void broadcast_handle_impl<T>::ack(std::uint64_t seq) {
+      slot &s = this->slot_of(seq);
+      
+      if(0 != --s.unacked)
+        return;
+      s.unacked = this->tree.children.size() + 1;
+      
+      if(this->tree.parent != -1) {
+        rpc_ff(this->tree.parent,
+          [](std::uintptr_t obj, std::uint64_t seq) {
+            reinterpret_cast<broadcast_handle_impl*>(obj)->ack(seq);
+          },
+          this->tree.parent_obj, seq
+        );
+        return;
+      }
+      
+      T value = std::move(s.value.value);
+      s.value.value.~T();
+      s.arrived = false;
+      
+      promise<T> answer = std::move(s.answer.value);
+      s.answer.value.~promise<T>();
+      s.called = false;
+      
+      s.next += this->slots.size();
+      
+      // Last, its callbacks may start the next call.
+      answer.fulfill_result(std::move(value));
+    }
+  }
+}
+#endif
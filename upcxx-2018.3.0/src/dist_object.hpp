@@ -5,6 +5,7 @@
 #include <upcxx/digest.hpp>
 #include <upcxx/future.hpp>
 #include <upcxx/rpc.hpp>
+#include <upcxx/team.hpp>
 #include <upcxx/utility.hpp>
 
 #include <cstdint>
@@ -22,10 +23,6 @@ namespace upcxx {
     // persona only.
     extern std::unordered_map<digest, void*> dist_master_promises;
     
-    // Collective counter for generating names, should be replaced by
-    // per-team counters.
-    extern std::uint64_t dist_master_id_bump;
-    
     // Get the promise pointer from the master map.
     template<typename T>
     promise<dist_object<T>&>* dist_promise(digest id) {
@@ -94,23 +91,24 @@ namespace std {
 namespace upcxx {
   template<typename T>
   class dist_object {
+    upcxx::team *tm_;
     digest id_;
     T value_;
     
   public:
-    dist_object(T value):
+    // Collective over `tm`.
+    dist_object(T value, upcxx::team &tm = upcxx::world()):
+      tm_{&tm},
+      id_{tm.next_collective_id()},
       value_{std::move(value)} {
       
-      // TODO: use team's collective digest generator
-      id_ = {0, detail::dist_master_id_bump};
-      detail::dist_master_id_bump += 1;
-      
       detail::dist_promise<T>(id_)->fulfill_result(*this); // future cascade, might delete this instance!
     }
     
     dist_object(dist_object const&) = delete;
     
     dist_object(dist_object &&that):
+      tm_{that.tm_},
       id_{that.id_},
       value_{std::move(that.value_)} {
       
@@ -139,8 +137,11 @@ namespace upcxx {
     
     dist_id<T> id() const { return dist_id<T>{id_}; }
     
+    upcxx::team& team() const { return *tm_; }
+    
+    // `rank` is relative to team().
     future<T> fetch(intrank_t rank) {
-      return upcxx::rpc(rank, [](dist_object<T> &o) { return *o; }, *this);
+      return upcxx::rpc((*tm_)[rank], [](dist_object<T> &o) { return *o; }, *this);
     }
   };
 }
@@ -225,7 +225,7 @@ void future_header_dependent::enter_proxying(
     
     if(this_refs == 0) {
       // nobody points to us, so we die...
-      operator delete(body->storage_);
+      ::operator delete(body->storage_);
       delete this;
     }
     else {
@@ -2,6 +2,7 @@
 #define _4281eee2_6d52_49d0_8126_75b21f8cb178
 
 #include <upcxx/diagnostic.hpp>
+#include <upcxx/pooled.hpp>
 #include <upcxx/utility.hpp>
 
 namespace upcxx {
@@ -249,8 +250,10 @@ namespace upcxx {
     // - Use their bodies to store their state while in wait.
     // - Don't store their own results, their "result_" points to the
     //   future_header_result<T...> holding the result.
+    // Like result headers they come from the thread's pooled free lists,
+    // a then() chain in a loop recycles the same few blocks.
     
-    struct future_header_dependent final: future_header {
+    struct future_header_dependent final: future_header, pooled_new {
       // For our potential members ship in the singly-linked "active queue".
       future_header_dependent *active_next_;
       
@@ -365,10 +368,13 @@ namespace upcxx {
     
     
     ////////////////////////////////////////////////////////////////////
-    // future_header_result<T...>: Header containing the result values
+    // future_header_result<T...>: Header containing the result values.
+    // Every promise and every ready future<T...> made from a value owns
+    // one, so they are pooled: small results cost a free list pop
+    // instead of a malloc.
     
     template<typename ...T>
-    struct future_header_result final: future_header {
+    struct future_header_result final: future_header, pooled_new {
       static constexpr int status_results_yes = status_active + 1;
       static constexpr int status_results_no = status_active + 2;
       
@@ -441,7 +447,7 @@ namespace upcxx {
     };
     
     template<>
-    struct future_header_result<> final: future_header {
+    struct future_header_result<> final: future_header, pooled_new {
       static future_header the_always;
       
       enum {
@@ -183,6 +183,9 @@ namespace upcxx {
     #endif
       -> decltype(this->result()) {
       
+      // A ready future never reaches progress or the dependency engine:
+      // ready() is a status read and result() follows the header to its
+      // results. Only the header itself was allocated, from the pool.
       while(!impl_.ready())
         progress();
       
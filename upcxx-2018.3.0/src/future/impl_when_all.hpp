@@ -4,6 +4,8 @@
 #include <upcxx/future/core.hpp>
 #include <upcxx/future/body_pure.hpp>
 
+#include <deque>
+
 namespace upcxx {
   //////////////////////////////////////////////////////////////////////
   // future_is_trivially_ready: future_impl_when_all specialization
@@ -224,6 +226,43 @@ namespace upcxx {
         return hdr;
       }
     };
+    
+    //////////////////////////////////////////////////////////////////////
+    // future_body_when_range: body of when_all(begin,end). Holds one
+    // dependency per argument that wasn't ready, the header's status
+    // counts them down. Results aren't gathered, the range's result is
+    // empty.
+    
+    template<typename FuArg>
+    struct future_body_when_range final: future_body {
+      // deque: dependencies link themselves into their argument's
+      // successor list, so must not move once built.
+      std::deque<future_dependency<FuArg>> deps_;
+      
+      future_body_when_range(void *storage):
+        future_body{storage} {
+      }
+      
+      void destruct_early() {
+        for(future_dependency<FuArg> &dep: this->deps_)
+          dep.cleanup_early();
+        this->~future_body_when_range();
+      }
+      
+      void leave_active(future_header_dependent *hdr) {
+        void *storage = this->storage_;
+        
+        for(future_dependency<FuArg> &dep: this->deps_)
+          dep.cleanup_ready();
+        this->~future_body_when_range();
+        ::operator delete(storage);
+        
+        if(0 == hdr->refs_drop(1)) // left active queue
+          delete hdr;
+        else
+          hdr->enter_ready(&future_header_result<>::the_always);
+      }
+    };
   }
 }
 #endif
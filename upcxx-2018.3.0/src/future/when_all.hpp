@@ -2,8 +2,12 @@
 #define _eb1a60f5_4086_4689_a513_8486eacfd815
 
 #include <upcxx/future/core.hpp>
+#include <upcxx/future/impl_shref.hpp>
 #include <upcxx/future/impl_when_all.hpp>
 
+#include <iterator>
+#include <type_traits>
+
 namespace upcxx {
   //////////////////////////////////////////////////////////////////////
   // when_all()
@@ -26,5 +30,33 @@ namespace upcxx {
       std::move(args)...
     };
   }
+  
+  // *** not spec'd ***
+  // Ready once every future in [begin,end) is. Their results are left in
+  // them, the returned future has none. Costs one header and body for
+  // the whole range plus a dependency per future not yet ready, so a
+  // batch of N operations can be waited on without N nested when_all's.
+  template<typename Iter,
+           typename = typename std::enable_if<!detail::is_future1<Iter>::value>::type>
+  future<> when_all(Iter begin, Iter end) {
+    typedef typename std::iterator_traits<Iter>::value_type fu_t;
+    typedef detail::future_body_when_range<fu_t> body_type;
+    
+    detail::future_header_dependent *hdr = new detail::future_header_dependent;
+    
+    void *body_mem = ::operator new(sizeof(body_type));
+    body_type *body = new(body_mem) body_type{body_mem};
+    hdr->body_ = body;
+    
+    for(; begin != end; ++begin) {
+      if(!begin->ready())
+        body->deps_.emplace_back(hdr, *begin);
+    }
+    
+    if(hdr->status_ == detail::future_header::status_active)
+      hdr->entered_active();
+    
+    return detail::future_impl_shref<detail::future_header_ops_general>{hdr};
+  }
 }
 #endif
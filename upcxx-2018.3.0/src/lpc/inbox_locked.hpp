@@ -2,13 +2,14 @@
 #define _67b46dbc_0075_4d4d_9e16_68ca3b7a80ff
 
 #include <upcxx/diagnostic.hpp>
+#include <upcxx/pooled.hpp>
 
 #include <mutex>
 
 namespace upcxx {
   namespace detail {
     struct lpc_inbox_locked_base {
-      struct lpc {
+      struct lpc: pooled_new {
         lpc *next;
         virtual void execute_and_delete() = 0;
       };
@@ -42,6 +43,11 @@ namespace upcxx {
     
     // returns num lpc's executed
     int burst(int q, int burst_n = 100);
+    
+    bool empty(int q) {
+      std::lock_guard<std::mutex> locked{this->lock_};
+      return this->head_[q] == nullptr;
+    }
   };
   
   //////////////////////////////////////////////////////////////////////
@@ -2,13 +2,14 @@
 #define _59d24b21_7503_4797_8c25_030246946671
 
 #include <upcxx/diagnostic.hpp>
+#include <upcxx/pooled.hpp>
 
 #include <atomic>
 
 namespace upcxx {
   namespace detail {
     struct lpc_inbox_lockfree_base {
-      struct lpc {
+      struct lpc: pooled_new {
         std::atomic<lpc*> next;
         virtual void execute_and_delete() = 0;
       };
@@ -41,6 +42,11 @@ namespace upcxx {
     
     // returns num lpc's executed
     int burst(int q, int burst_n = 100);
+    
+    // A snapshot, senders may be adding as we speak.
+    bool empty(int q) const {
+      return this->head_[q].load(std::memory_order_relaxed) == nullptr;
+    }
   };
   
   //////////////////////////////////////////////////////////////////////
@@ -2,11 +2,12 @@
 #define _b68cb319_851a_4f86_bf16_a95c9b16a93f
 
 #include <upcxx/diagnostic.hpp>
+#include <upcxx/pooled.hpp>
 
 namespace upcxx {
   namespace detail {
     struct lpc_inbox_syncfree_base {
-      struct lpc {
+      struct lpc: pooled_new {
         lpc *next;
         virtual void execute_and_delete() = 0;
       };
@@ -39,6 +40,8 @@ namespace upcxx {
     
     // returns num lpc's executed
     int burst(int q, int burst_n = 100);
+    
+    bool empty(int q) const { return this->head_[q] == nullptr; }
   };
   
   //////////////////////////////////////////////////////////////////////
@@ -6,7 +6,8 @@ on the structure and interpretation of a rule-file.
 @rule()
 def requires_pthread(cxt, src):
   return src in [
-    here('lpc/inbox_locked.hpp')
+    here('lpc/inbox_locked.hpp'),
+    here('progress_thread.hpp')
   ]
 
 @rule()
@@ -47,6 +48,14 @@ def required_libraries(cxt, src):
       }
     }}
     
+  elif src == here('stats.hpp'):
+    # Anyone including "stats.hpp" gets UPCXX_STATS_ENABLED defined.
+    return {'upcxx-stats': {
+      'ppdefs': {
+        'UPCXX_STATS_ENABLED': 1 if cxt.upcxx_stats_enabled() else 0
+      }
+    }}
+    
   else:
     # Parent "nobsrule.py" handles other cases.
     return cxt.required_libraries(src)
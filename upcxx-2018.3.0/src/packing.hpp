@@ -835,6 +835,46 @@ namespace upcxx {
       return xs;
     }
   };
+  
+  
+  //////////////////////////////////////////////////////////////////////
+  // detail::trivial_chunk: Contiguous run of trivially copyable elements
+  // for the bulk collectives. Packed with a single copy straight out of
+  // `src`, unpacks into `elts` (and a null `src`).
+  
+  namespace detail {
+    template<typename T>
+    struct trivial_chunk {
+      static_assert(std::is_trivially_copyable<T>::value,
+        "Bulk collectives require trivially copyable elements.");
+      
+      T const *src;
+      std::size_t n;
+      // mutable so handlers can move it out of their const& argument
+      mutable std::vector<T> elts;
+      
+      T const* data() const { return src != nullptr ? src : elts.data(); }
+    };
+  }
+  
+  template<typename T>
+  struct packing<detail::trivial_chunk<T>> {
+    static void size_ubound(parcel_layout &ub, const detail::trivial_chunk<T> &x) {
+      packing<std::size_t>::size_ubound(ub, x.n);
+      ub.add_bytes(x.n*sizeof(T), alignof(T));
+    }
+    
+    static void pack(parcel_writer &w, const detail::trivial_chunk<T> &x) {
+      packing<std::size_t>::pack(w, x.n);
+      w.put_trivial_aligned(x.data(), x.n);
+    }
+    
+    static detail::trivial_chunk<T> unpack(parcel_reader &r) {
+      std::size_t n = packing<std::size_t>::unpack(r);
+      T const *elts = r.pop_trivial_aligned<T>(n);
+      return detail::trivial_chunk<T>{nullptr, n, std::vector<T>(elts, elts + n)};
+    }
+  };
 }
 #if UPCXXI_DIAG_POP
   #pragma GCC diagnostic pop
@@ -4,6 +4,7 @@
 #include <upcxx/backend_fwd.hpp>
 #include <upcxx/future.hpp>
 #include <upcxx/lpc/inbox.hpp>
+#include <upcxx/stats.hpp>
 
 #include <type_traits>
 
@@ -43,6 +44,10 @@ namespace upcxx {
     // Returns number of callbacks fired. Persona must be top-most active
     // on this thread.
     int persona_burst(persona&, progress_level level);
+    
+    // Whether lpc's runnable at `level` are waiting. Persona must be
+    // active with calling thread.
+    bool persona_lpcs_waiting(persona&, progress_level level);
   }
   
   //////////////////////////////////////////////////////////////////////
@@ -63,6 +68,7 @@ namespace upcxx {
     friend void detail::persona_as_top(persona&, Fn&&);
     
     friend int detail::persona_burst(persona&, progress_level);
+    friend bool detail::persona_lpcs_waiting(persona&, progress_level);
     
     friend persona_scope& top_persona_scope();
     
@@ -344,7 +350,19 @@ namespace upcxx {
       p.burstable_[q_user] = true;
     }
     
+    UPCXX_STATS_ADD(lpc_n, exec_n);
     return exec_n;
   }
+  
+  inline bool detail::persona_lpcs_waiting(persona &p, upcxx::progress_level level) {
+    constexpr int q_internal = (int)progress_level::internal;
+    constexpr int q_user     = (int)progress_level::user;
+    
+    if(!p.peer_inbox_.empty(q_internal) || !p.self_inbox_.empty(q_internal))
+      return true;
+    
+    return level == progress_level::user &&
+      (!p.peer_inbox_.empty(q_user) || !p.self_inbox_.empty(q_user));
+  }
 }
 #endif
@@ -0,0 +1,86 @@
+#include <upcxx/pooled.hpp>
+#include <upcxx/backend.hpp>
+#include <upcxx/diagnostic.hpp>
+
+namespace upcxx {
+  namespace detail {
+    thread_local pooled_cache tl_pooled_cache;
+    thread_local pooled_cache tl_pooled_segment_cache;
+  }
+}
+
+using upcxx::detail::pooled_cache;
+using upcxx::detail::tl_pooled_cache;
+
+namespace {
+  // Returns the thread's cached blocks to the heap when it exits. Being
+  // non-trivial it only exists on threads that touched it, which
+  // pooled_arm() does before a thread caches its first block.
+  struct pooled_reaper {
+    ~pooled_reaper() {
+      pooled_cache &pc = tl_pooled_cache;
+      pc.state = pooled_cache::dead;
+      
+      for(int c=0; c != pooled_cache::class_n; c++) {
+        while(pc.head[c] != nullptr) {
+          void *p = pc.head[c];
+          pc.head[c] = *static_cast<void**>(p);
+          ::operator delete(p);
+        }
+        pc.count[c] = 0;
+      }
+    }
+  };
+  
+  thread_local pooled_reaper tl_pooled_reaper;
+  
+  // Whether this thread may cache blocks.
+  bool pooled_arm() {
+    pooled_cache &pc = tl_pooled_cache;
+    
+    if(pc.state == pooled_cache::unused) {
+      (void)&tl_pooled_reaper;
+      pc.state = pooled_cache::live;
+    }
+    return pc.state == pooled_cache::live;
+  }
+}
+
+void* upcxx::detail::pooled_allocate_slow(std::size_t size) {
+  std::size_t c = (size-1)/16;
+  
+  // Round up so the block fits any later use of its class.
+  if(c < pooled_cache::class_n)
+    size = (c+1)*16;
+  
+  return ::operator new(size);
+}
+
+void upcxx::detail::pooled_deallocate_slow(void *p, std::size_t size) {
+  std::size_t c = (size-1)/16;
+  pooled_cache &pc = tl_pooled_cache;
+  
+  if(c < pooled_cache::class_n && pc.count[c] < pooled_cache::keep_n && pooled_arm()) {
+    *static_cast<void**>(p) = pc.head[c];
+    pc.head[c] = p;
+    pc.count[c] += 1;
+  }
+  else
+    ::operator delete(p);
+}
+
+void* upcxx::detail::pooled_segment_allocate_slow(std::size_t size) {
+  std::size_t c = (size-1)/16;
+  
+  if(c < pooled_cache::class_n)
+    size = (c+1)*16;
+  
+  void *p = upcxx::allocate(size, pooled_segment_align);
+  UPCXX_ASSERT_ALWAYS(p != nullptr, "Exhausted shared segment!");
+  return p;
+}
+
+void upcxx::detail::pooled_segment_deallocate_slow(void *p, std::size_t) {
+  // only reached past the cap or for blocks bigger than the classes
+  upcxx::deallocate(p);
+}
@@ -0,0 +1,116 @@
+#ifndef _687bb64b_1f51_43bc_942a_f9eff5467687
+#define _687bb64b_1f51_43bc_942a_f9eff5467687
+
+#include <cstddef>
+#include <new>
+
+namespace upcxx {
+  namespace detail {
+    /* Small-object allocator for the runtime's short-lived callback
+     * objects (handle_cb's, lpc's). Every thread keeps LIFO free lists
+     * per 16-byte size class, so the callback a thread just retired is
+     * the memory of the next one it issues, and threads never contend.
+     * A block may be freed by another thread than allocated it, it then
+     * joins that thread's lists.
+     */
+    struct pooled_cache {
+      static constexpr int class_n = 16; // 16 to 256 bytes
+      static constexpr int keep_n = 256; // blocks kept per class
+      
+      enum { unused, live, dead }; // dead: thread exited, no more caching
+      
+      void *head[class_n];
+      int count[class_n];
+      int state;
+    };
+    
+    // Zero initialized, needs no constructor.
+    extern thread_local pooled_cache tl_pooled_cache;
+    
+    void* pooled_allocate_slow(std::size_t size);
+    void pooled_deallocate_slow(void *p, std::size_t size);
+    
+    inline void* pooled_allocate(std::size_t size) {
+      std::size_t c = (size-1)/16;
+      pooled_cache &pc = tl_pooled_cache;
+      
+      if(c < pooled_cache::class_n && pc.head[c] != nullptr) {
+        void *p = pc.head[c];
+        pc.head[c] = *static_cast<void**>(p);
+        pc.count[c] -= 1;
+        return p;
+      }
+      
+      return pooled_allocate_slow(size);
+    }
+    
+    // `size` must be what the block was allocated with.
+    inline void pooled_deallocate(void *p, std::size_t size) {
+      std::size_t c = (size-1)/16;
+      pooled_cache &pc = tl_pooled_cache;
+      
+      if(c < pooled_cache::class_n && pc.count[c] < pooled_cache::keep_n &&
+         pc.state == pooled_cache::live) {
+        *static_cast<void**>(p) = pc.head[c];
+        pc.head[c] = p;
+        pc.count[c] += 1;
+      }
+      else
+        pooled_deallocate_slow(p, size);
+    }
+    
+    // Inherit for pooled operator new/delete. Objects have to be deleted
+    // through their most derived type, so the size delete sees is the
+    // one new saw.
+    struct pooled_new {
+      static void* operator new(std::size_t size) {
+        return pooled_allocate(size);
+      }
+      static void operator delete(void *p, std::size_t size) {
+        pooled_deallocate(p, size);
+      }
+    };
+    
+    /* Same, over blocks of the shared segment (upcxx::allocate), for
+     * callbacks gasnet transfers into. Blocks are aligned to
+     * pooled_segment_align. A thread's cached blocks are not given back
+     * when it exits, which may be after finalize(), so a thread strands
+     * at most keep_n blocks per class.
+     */
+    constexpr std::size_t pooled_segment_align = 16;
+    
+    extern thread_local pooled_cache tl_pooled_segment_cache;
+    
+    void* pooled_segment_allocate_slow(std::size_t size);
+    void pooled_segment_deallocate_slow(void *p, std::size_t size);
+    
+    inline void* pooled_segment_allocate(std::size_t size) {
+      std::size_t c = (size-1)/16;
+      pooled_cache &pc = tl_pooled_segment_cache;
+      
+      if(c < pooled_cache::class_n && pc.head[c] != nullptr) {
+        void *p = pc.head[c];
+        pc.head[c] = *static_cast<void**>(p);
+        pc.count[c] -= 1;
+        return p;
+      }
+      
+      return pooled_segment_allocate_slow(size);
+    }
+    
+    // `size` must be what the block was allocated with.
+    inline void pooled_segment_deallocate(void *p, std::size_t size) {
+      std::size_t c = (size-1)/16;
+      pooled_cache &pc = tl_pooled_segment_cache;
+      
+      if(c < pooled_cache::class_n && pc.count[c] < pooled_cache::keep_n) {
+        *static_cast<void**>(p) = pc.head[c];
+        pc.head[c] = p;
+        pc.count[c] += 1;
+      }
+      else
+        pooled_segment_deallocate_slow(p, size);
+    }
+  }
+}
+#endif
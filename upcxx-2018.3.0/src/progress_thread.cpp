@@ -0,0 +1,53 @@
+#include <upcxx/progress_thread.hpp>
+#include <upcxx/backend/gasnet/runtime.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+namespace backend = upcxx::backend;
+namespace gasnet = upcxx::backend::gasnet;
+
+using upcxx::persona_scope;
+using upcxx::progress_level;
+using upcxx::progress_thread;
+
+upcxx::progress_thread::progress_thread(int idle_spins, double max_sleep_us):
+  stop_{false} {
+  
+  UPCXX_ASSERT_ALWAYS(!UPCXX_BACKEND_GASNET_SEQ,
+    "upcxx::progress_thread requires UPCXX_THREADMODE=par."
+  );
+  
+  // Leaves the master persona in no thread's stack.
+  upcxx::liberate_master_persona();
+  
+  this->thread_ = std::thread(
+    [=]() { this->run_(idle_spins, max_sleep_us); }
+  );
+}
+
+upcxx::progress_thread::~progress_thread() {
+  this->stop_.store(true, std::memory_order_relaxed);
+  this->thread_.join();
+  
+  // Back to how init() left us.
+  backend::initial_master_scope = new persona_scope{backend::master};
+}
+
+void upcxx::progress_thread::run_(int idle_spins, double max_sleep_us) {
+  persona_scope master_scope{backend::master};
+  
+  int idle_n = 0;
+  double sleep_us = 1;
+  
+  while(!this->stop_.load(std::memory_order_relaxed)) {
+    if(gasnet::progress_burst(progress_level::internal) != 0) {
+      idle_n = 0;
+      sleep_us = 1;
+    }
+    else if(++idle_n > idle_spins) {
+      std::this_thread::sleep_for(std::chrono::duration<double, std::micro>(sleep_us));
+      sleep_us = std::min(2*sleep_us, max_sleep_us);
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef _47b8a6ce_ab6f_4af9_939a_367a3decf44d
+#define _47b8a6ce_ab6f_4af9_939a_367a3decf44d
+
+#include <upcxx/backend.hpp>
+
+#include <atomic>
+#include <thread>
+
+namespace upcxx {
+  // *** not spec'd ***
+  // Keeps communication moving while the thread that built it computes.
+  // The constructor hands the master persona to a new thread, which
+  // polls the network and runs internal-level progress until the
+  // destructor takes the persona back. User-level callbacks (rpc's, rpc
+  // and lpc completions) wait for the builder's next user progress.
+  //
+  // The builder must be the thread that called init() and must still
+  // hold the master persona it got there. It may not communicate until
+  // the destructor, and neither may anyone else need the master persona.
+  // Requires the par thread mode.
+  class progress_thread {
+    std::thread thread_;
+    std::atomic<bool> stop_;
+    
+    void run_(int idle_spins, double max_sleep_us);
+    
+  public:
+    // After `idle_spins` consecutive polls find nothing to do the thread
+    // sleeps between polls, starting at 1us and doubling up to
+    // `max_sleep_us`. Work resets both.
+    progress_thread(int idle_spins = 100, double max_sleep_us = 50);
+    ~progress_thread();
+    
+    progress_thread(progress_thread const&) = delete;
+  };
+}
+#endif
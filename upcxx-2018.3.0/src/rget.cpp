@@ -1,5 +1,6 @@
 #include <upcxx/rget.hpp>
 #include <upcxx/backend/gasnet/runtime_internal.hpp>
+#include <upcxx/stats.hpp>
 
 namespace gasnet = upcxx::backend::gasnet;
 
@@ -10,6 +11,24 @@ void upcxx::detail::rma_get_nb(
     std::size_t buf_size,
     gasnet::handle_cb *cb
   ) {
+  
+  UPCXX_STATS_ADD(rget_n, 1);
+  UPCXX_STATS_ADD(rget_bytes, buf_size);
+  
+  gasnet::nbi_region_cb *region = gasnet::tl_nbi_region;
+  
+  if(region != nullptr) {
+    (void)gex_RMA_GetNBI(
+      gasnet::world_team,
+      buf_d, rank_s, const_cast<void*>(buf_s), buf_size,
+      /*flags*/0
+    );
+    
+    region->cbs.push_back(cb);
+    
+    gasnet::after_gasnet();
+    return;
+  }
 
   gex_Event_t h = gex_RMA_GetNB(
     gasnet::world_team,
@@ -29,6 +48,9 @@ void upcxx::detail::rma_get_b(
     std::size_t buf_size
   ) {
 
+  UPCXX_STATS_ADD(rget_n, 1);
+  UPCXX_STATS_ADD(rget_bytes, buf_size);
+  
   (void)gex_RMA_GetBlocking(
     gasnet::world_team,
     buf_d, rank_s, const_cast<void*>(buf_s), buf_size,
@@ -137,12 +137,18 @@ namespace upcxx {
         delete this;
       }
 
-      // we allocate this class in the segment for performance with gasnet
+      // we allocate this class in the segment for performance with gasnet,
+      // from the pooled segment blocks unless it needs a bigger alignment
       static void* operator new(std::size_t size) {
-        return upcxx::allocate(size, alignof(rget_cb_byval));
+        return alignof(rget_cb_byval) <= detail::pooled_segment_align
+          ? detail::pooled_segment_allocate(size)
+          : upcxx::allocate(size, alignof(rget_cb_byval));
       }
-      static void operator delete(void *p) {
-        upcxx::deallocate(p);
+      static void operator delete(void *p, std::size_t size) {
+        if(alignof(rget_cb_byval) <= detail::pooled_segment_align)
+          detail::pooled_segment_deallocate(p, size);
+        else
+          upcxx::deallocate(p);
       }
     };
   }
@@ -0,0 +1,254 @@
+#ifndef _9514dd9e_5ac4_43a8_8c3c_b9dd76df27d0
+#define _9514dd9e_5ac4_43a8_8c3c_b9dd76df27d0
+
+#include <upcxx/allreduce_bulk.hpp>
+#include <upcxx/backend.hpp>
+#include <upcxx/rput.hpp>
+#include <upcxx/team.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/* Collectives over small fixed-size values without active messages.
+ * Every member owns a block of flags and value slots in the shared
+ * segment, whose address all members learn at construction. A step puts
+ * the value into the peer's slot, then the call's sequence number into
+ * the slot's flag, and the peer spins on its own flag. No handler runs
+ * and nothing is allocated per step, so on the smp/PSHM conduit a step
+ * costs two memcpy's.
+ *
+ * The calls block (spinning with internal progress) rather than return
+ * futures, they are meant for latency-bound loops.
+ */
+
+namespace upcxx {
+  template<typename T>
+  class rma_coll {
+    static_assert(std::is_trivially_copyable<T>::value,
+      "rma_coll<T> moves T's by memcpy, T must be trivially copyable."
+    );
+    
+    typedef std::atomic<std::uint64_t> flag_t;
+    
+    struct entry {
+      T value;
+      bool set; // broadcast: value is the root's
+    };
+    
+    team *tm_;
+    // dissemination rounds of the barrier, recursive doubling steps of
+    // the reductions
+    int barrier_n_, step_n_;
+    // largest power of 2 not above rank_n
+    intrank_t pof2_;
+    // Block layout: barrier_n_ barrier flags, 2 sets of step_n_+2
+    // reduction flags, then 2 sets of step_n_+2 entries at entries_off_.
+    // Reduction call seq uses set seq&1. Reduction slot 0 is the fold-in
+    // of the ranks past pof2_, slot step_n_+1 their fold-out.
+    std::size_t entries_off_;
+    char *mine_;
+    // every member's block, by team rank
+    std::vector<std::uintptr_t> bases_;
+    // calls made
+    std::uint64_t barrier_seq_, reduce_seq_;
+    
+    flag_t& flag_(std::size_t i) {
+      return *reinterpret_cast<flag_t*>(mine_ + i*sizeof(flag_t));
+    }
+    entry& entry_(int s) {
+      return reinterpret_cast<entry*>(mine_ + entries_off_)[s];
+    }
+    
+    // Puts `e` (if given) into entry `s` of `peer`, then `seq` into its
+    // flag `flag_i`.
+    void signal_(intrank_t peer, std::size_t flag_i, std::uint64_t seq,
+                 entry const *e = nullptr, int s = 0);
+    void wait_(std::size_t flag_i, std::uint64_t seq);
+    
+    template<typename Combine>
+    entry reduce_(entry e, Combine combine);
+  
+  public:
+    // Collective over `tm`, allocates from the shared segment.
+    rma_coll(team &tm = upcxx::world());
+    // Collective over the team.
+    ~rma_coll();
+    
+    rma_coll(rma_coll const&) = delete;
+    
+    // The calls are collective over the team, members make them in the
+    // same order.
+    
+    void barrier();
+    
+    // `op` must be commutative and associative. Both members of a pair
+    // combine in rank order, so all members get bitwise equal results.
+    template<typename BinaryOp>
+    T allreduce(T value, BinaryOp op);
+    
+    // `root` is a rank in the team, `value` is only read on it.
+    T broadcast(T value, intrank_t root);
+  };
+  
+  //////////////////////////////////////////////////////////////////////
+  
+  template<typename T>
+  rma_coll<T>::rma_coll(team &tm):
+    tm_{&tm},
+    barrier_seq_{0},
+    reduce_seq_{0} {
+    
+    intrank_t rank_n = tm.rank_n();
+    
+    this->barrier_n_ = 0;
+    while((intrank_t(1) << this->barrier_n_) < rank_n)
+      this->barrier_n_ += 1;
+    
+    this->step_n_ = 0;
+    while((intrank_t(2) << this->step_n_) <= rank_n)
+      this->step_n_ += 1;
+    this->pof2_ = intrank_t(1) << this->step_n_;
+    
+    std::size_t flag_n = this->barrier_n_ + 2*(this->step_n_ + 2);
+    std::size_t align = alignof(entry) < alignof(flag_t) ? alignof(flag_t) : alignof(entry);
+    this->entries_off_ = (flag_n*sizeof(flag_t) + align-1)/align*align;
+    
+    this->mine_ = static_cast<char*>(upcxx::allocate(
+      this->entries_off_ + 2*(this->step_n_ + 2)*sizeof(entry), align
+    ));
+    UPCXX_ASSERT_ALWAYS(this->mine_ != nullptr, "Exhausted shared segment in rma_coll!");
+    
+    for(std::size_t i=0; i != flag_n; i++)
+      ::new(&this->flag_(i)) flag_t(0);
+    
+    // Our flags are set before anyone learns where they are.
+    std::vector<std::uintptr_t> bases(rank_n, 0);
+    bases[tm.rank_me()] = reinterpret_cast<std::uintptr_t>(this->mine_);
+    this->bases_.resize(rank_n);
+    upcxx::allreduce(
+      bases.data(), this->bases_.data(), rank_n,
+      std::plus<std::uintptr_t>(), tm
+    ).wait();
+  }
+  
+  template<typename T>
+  rma_coll<T>::~rma_coll() {
+    // Peers may still be signalling us from the last barrier().
+    upcxx::barrier(*this->tm_);
+    upcxx::deallocate(this->mine_);
+  }
+  
+  template<typename T>
+  void rma_coll<T>::signal_(
+      intrank_t peer, std::size_t flag_i, std::uint64_t seq,
+      entry const *e, int s
+    ) {
+    intrank_t rank = (*this->tm_)[peer];
+    std::uintptr_t base = this->bases_[peer];
+    
+    if(e != nullptr) {
+      detail::rma_put_b(rank,
+        reinterpret_cast<void*>(base + this->entries_off_ + s*sizeof(entry)),
+        e, sizeof(entry)
+      );
+    }
+    
+    // The blocking put returns once the entry landed, keep our stores
+    // in that order for a peer reading through shared memory.
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    detail::rma_put_b(rank,
+      reinterpret_cast<void*>(base + flag_i*sizeof(flag_t)),
+      &seq, sizeof(seq)
+    );
+  }
+  
+  template<typename T>
+  void rma_coll<T>::wait_(std::size_t flag_i, std::uint64_t seq) {
+    // Later calls only ever raise a flag, so a peer running ahead in the
+    // barrier cannot make us miss this one.
+    while(this->flag_(flag_i).load(std::memory_order_acquire) < seq)
+      upcxx::progress(progress_level::internal);
+  }
+  
+  template<typename T>
+  void rma_coll<T>::barrier() {
+    std::uint64_t seq = ++this->barrier_seq_;
+    intrank_t rank_me = this->tm_->rank_me();
+    intrank_t rank_n = this->tm_->rank_n();
+    
+    for(int k=0; k != this->barrier_n_; k++) {
+      this->signal_((rank_me + (intrank_t(1)<<k)) % rank_n, k, seq);
+      this->wait_(k, seq);
+    }
+  }
+  
+  template<typename T>
+  template<typename Combine>
+  typename rma_coll<T>::entry rma_coll<T>::reduce_(entry e, Combine combine) {
+    std::uint64_t seq = ++this->reduce_seq_;
+    intrank_t rank_me = this->tm_->rank_me();
+    intrank_t rank_n = this->tm_->rank_n();
+    
+    // reduction slot s of this call is entry e0 + s, with flag flag0 + s
+    int e0 = int(seq & 1)*(this->step_n_ + 2);
+    std::size_t flag0 = this->barrier_n_ + e0;
+    int last = this->step_n_ + 1;
+    
+    // A peer next writes these slots in call seq+2. To get there it has
+    // to finish seq+1, which needs our signals of seq+1, and we send
+    // those only after reading seq's values here. With a single set the
+    // peer's seq+1 could land while we still wait on seq.
+    
+    if(this->pof2_ <= rank_me) {
+      this->signal_(rank_me - this->pof2_, flag0, seq, &e, e0);
+      this->wait_(flag0 + last, seq);
+      return this->entry_(e0 + last);
+    }
+    
+    bool folds = rank_me + this->pof2_ < rank_n;
+    
+    if(folds) {
+      this->wait_(flag0, seq);
+      e = combine(e, this->entry_(e0));
+    }
+    
+    for(int s=1; s <= this->step_n_; s++) {
+      intrank_t peer = rank_me ^ (intrank_t(1) << (s-1));
+      this->signal_(peer, flag0 + s, seq, &e, e0 + s);
+      this->wait_(flag0 + s, seq);
+      e = peer < rank_me
+        ? combine(this->entry_(e0 + s), e)
+        : combine(e, this->entry_(e0 + s));
+    }
+    
+    if(folds)
+      this->signal_(rank_me + this->pof2_, flag0 + last, seq, &e, e0 + last);
+    
+    return e;
+  }
+  
+  template<typename T>
+  template<typename BinaryOp>
+  T rma_coll<T>::allreduce(T value, BinaryOp op) {
+    return this->reduce_(entry{value, true},
+      [&](entry const &a, entry const &b) {
+        return entry{op(a.value, b.value), true};
+      }
+    ).value;
+  }
+  
+  template<typename T>
+  T rma_coll<T>::broadcast(T value, intrank_t root) {
+    return this->reduce_(entry{value, this->tm_->rank_me() == root},
+      [](entry const &a, entry const &b) {
+        return a.set ? a : b;
+      }
+    ).value;
+  }
+}
+#endif
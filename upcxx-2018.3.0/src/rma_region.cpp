@@ -0,0 +1,23 @@
+#include <upcxx/rma_region.hpp>
+#include <upcxx/backend.hpp>
+#include <upcxx/backend/gasnet/runtime_internal.hpp>
+
+namespace gasnet = upcxx::backend::gasnet;
+
+upcxx::rma_region::rma_region() {
+  UPCXX_ASSERT(gasnet::tl_nbi_region == nullptr, "upcxx::rma_region's do not nest.");
+  
+  gasnet::tl_nbi_region = new gasnet::nbi_region_cb;
+  gex_NBI_BeginAccessRegion(/*flags*/0);
+}
+
+upcxx::rma_region::~rma_region() {
+  gasnet::nbi_region_cb *cb = gasnet::tl_nbi_region;
+  gasnet::tl_nbi_region = nullptr;
+  
+  gex_Event_t h = gex_NBI_EndAccessRegion(/*flags*/0);
+  cb->handle = reinterpret_cast<uintptr_t>(h);
+  
+  gasnet::register_cb(cb);
+  gasnet::after_gasnet();
+}
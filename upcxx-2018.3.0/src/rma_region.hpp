@@ -0,0 +1,19 @@
+#ifndef _1a8bc488_2633_46b1_bbf4_ad4400cb847d
+#define _1a8bc488_2633_46b1_bbf4_ad4400cb847d
+
+namespace upcxx {
+  // *** not spec'd ***
+  // While one of these is alive, the rput's and rget's this thread issues
+  // (except those asking for source_cx notification) go out as implicit
+  // NBI operations sharing a single sync point. None of them completes
+  // before the region ends, so don't wait on them inside it. Regions
+  // don't nest and must end on the thread that began them.
+  class rma_region {
+  public:
+    rma_region();
+    ~rma_region();
+    
+    rma_region(rma_region const&) = delete;
+  };
+}
+#endif
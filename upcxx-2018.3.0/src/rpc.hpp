@@ -83,9 +83,11 @@ namespace upcxx {
       CxsState *state_;
 
       struct operation_satisfier {
+        persona *initiator_persona;
         CxsState *state;
         template<typename ...T>
         void operator()(T &&...vals) {
+          initiator_persona->backend_state_.rpc_replies_awaited -= 1;
           state->template operator()<operation_cx_event>(std::forward<T>(vals)...);
           delete state;
         }
@@ -96,7 +98,10 @@ namespace upcxx {
         backend::template send_am_persona<progress_level::user>(
           initiator_,
           initiator_persona_,
-          upcxx::bind(operation_satisfier{state_}, std::forward<Args>(args)...)
+          upcxx::bind(
+            operation_satisfier{initiator_persona_, state_},
+            std::forward<Args>(args)...
+          )
         );
       }
     };
@@ -153,6 +158,7 @@ namespace upcxx {
 
     intrank_t initiator = backend::rank_me;
     persona *initiator_persona = &upcxx::current_persona();
+    initiator_persona->backend_state_.rpc_replies_awaited += 1;
     auto fn_bound = upcxx::bind(std::forward<Fn>(fn), std::forward<Args>(args)...);
     
     backend::template send_am_master<progress_level::user>(
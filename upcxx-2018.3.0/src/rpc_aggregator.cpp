@@ -0,0 +1,152 @@
+#include <upcxx/rpc_aggregator.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace detail = upcxx::detail;
+namespace gasnet = upcxx::backend::gasnet;
+
+using upcxx::future;
+using upcxx::intrank_t;
+using upcxx::parcel_layout;
+using upcxx::parcel_reader;
+using upcxx::parcel_writer;
+using upcxx::rpc_aggregator;
+
+using namespace std;
+
+namespace {
+  typedef future<>(*exec_t)(parcel_reader&);
+}
+
+thread_local rpc_aggregator *detail::tl_rpc_aggregators = nullptr;
+
+future<> detail::rpc_aggregator_execute(parcel_reader &r) {
+  uint32_t n = r.pop_trivial_aligned<uint32_t>();
+  
+  // The landing buffer stays until every command is done with it.
+  future<> done = upcxx::make_future();
+  
+  while(n--) {
+    future<> f = command_execute(r);
+    if(!f.ready())
+      done = upcxx::when_all(done, f);
+  }
+  
+  return done;
+}
+
+void detail::rpc_aggregators_progress() {
+  rpc_aggregator::clock::time_point now = rpc_aggregator::clock::now();
+  
+  for(rpc_aggregator *a = tl_rpc_aggregators; a != nullptr; a = a->next_) {
+    if(!a->dirty_.empty() && a->delay_ <= now - a->oldest_)
+      a->flush();
+  }
+}
+
+rpc_aggregator::rpc_aggregator(std::size_t flush_bytes, double flush_us):
+  cap_{std::min(flush_bytes, gasnet::am_size_medium_max)},
+  delay_{std::chrono::duration_cast<clock::duration>(
+    std::chrono::duration<double, std::micro>(flush_us)
+  )},
+  batches_(backend::rank_n, batch{nullptr, parcel_layout{}, 0, 0, 0}) {
+  
+  exec_t exec = detail::rpc_aggregator_execute;
+  packing<exec_t>::size_ubound(this->hdr_ub_, exec);
+  this->hdr_ub_.add_trivial_aligned<uint32_t>();
+  
+  this->prev_ = nullptr;
+  this->next_ = detail::tl_rpc_aggregators;
+  if(this->next_ != nullptr)
+    this->next_->prev_ = this;
+  detail::tl_rpc_aggregators = this;
+}
+
+rpc_aggregator::~rpc_aggregator() {
+  this->flush();
+  
+  if(this->prev_ != nullptr)
+    this->prev_->next_ = this->next_;
+  else
+    detail::tl_rpc_aggregators = this->next_;
+  if(this->next_ != nullptr)
+    this->next_->prev_ = this->prev_;
+  
+  for(batch &b: this->batches_)
+    std::free(b.buf);
+}
+
+parcel_writer rpc_aggregator::writer_(intrank_t recipient) {
+  batch &b = this->batches_[recipient];
+  
+  if(b.buf == nullptr) {
+    void *buf;
+    int ok = posix_memalign(&buf, batch_align, this->cap_);
+    UPCXX_ASSERT_ALWAYS(ok == 0);
+    b.buf = static_cast<char*>(buf);
+  }
+  
+  parcel_writer w{b.buf};
+  
+  if(b.cmd_n == 0) {
+    exec_t exec = detail::rpc_aggregator_execute;
+    packing<exec_t>::pack(w, exec);
+    b.count_off = w.put_trivial_aligned(uint32_t(0)) - reinterpret_cast<uint32_t*>(b.buf);
+  }
+  else
+    w.lay_ = b.lay;
+  
+  return w;
+}
+
+void rpc_aggregator::added_(intrank_t recipient, parcel_layout lay) {
+  batch &b = this->batches_[recipient];
+  
+  b.lay = lay;
+  
+  if(b.cmd_n++ == 0) {
+    if(this->dirty_.empty())
+      this->oldest_ = clock::now();
+    b.dirty_ix = this->dirty_.size();
+    this->dirty_.push_back(recipient);
+  }
+}
+
+void rpc_aggregator::send_(intrank_t recipient) {
+  UPCXX_ASSERT(!UPCXX_BACKEND_GASNET_SEQ || backend::master.active_with_caller());
+  
+  batch &b = this->batches_[recipient];
+  
+  reinterpret_cast<uint32_t*>(b.buf)[b.count_off] = b.cmd_n;
+  b.cmd_n = 0;
+  
+  // The medium AM is injected from buf before this returns, so the
+  // buffer is ready for the next batch.
+  gasnet::send_am_eager_master(
+    progress_level::user, recipient,
+    b.buf, b.lay.size(), b.lay.alignment()
+  );
+}
+
+void rpc_aggregator::flush(intrank_t recipient) {
+  if(this->batches_[recipient].cmd_n == 0)
+    return;
+  
+  this->send_(recipient);
+  
+  // Swap the last rank into our place.
+  std::size_t ix = this->batches_[recipient].dirty_ix;
+  intrank_t last = this->dirty_.back();
+  this->dirty_[ix] = last;
+  this->batches_[last].dirty_ix = ix;
+  this->dirty_.pop_back();
+  // oldest_ may now be older than what's left, which only flushes it
+  // early.
+}
+
+void rpc_aggregator::flush() {
+  for(intrank_t recipient: this->dirty_)
+    this->send_(recipient);
+  this->dirty_.clear();
+}
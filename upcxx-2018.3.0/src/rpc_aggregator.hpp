@@ -0,0 +1,128 @@
+#ifndef _37b76678_09c8_4acd_b80d_9ac0a3495766
+#define _37b76678_09c8_4acd_b80d_9ac0a3495766
+
+#include <upcxx/backend.hpp>
+#include <upcxx/bind.hpp>
+#include <upcxx/command.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/* Aggregation of small rpc_ff's. Commands for the same rank are packed
+ * back to back into that rank's batch buffer, which goes out as a single
+ * eager AM once it is full, once its oldest command is older than the
+ * delay (checked by progress), or on flush(). The receiver runs the
+ * whole batch out of the one landing buffer.
+ *
+ * A batch is itself a command, whose executor pops the command count and
+ * then executes that many commands off the same reader:
+ *
+ *   [rpc_aggregator_execute][uint32 n][command 0]...[command n-1]
+ */
+
+namespace upcxx {
+  class rpc_aggregator;
+  
+  namespace detail {
+    // Executor of a batch.
+    future<> rpc_aggregator_execute(parcel_reader &r);
+    
+    // Flushes the overdue batches of this thread's aggregators, called
+    // by progress().
+    void rpc_aggregators_progress();
+    
+    // head of this thread's aggregators
+    extern thread_local rpc_aggregator *tl_rpc_aggregators;
+  }
+  
+  // *** not spec'd ***
+  // Batches the rpc_ff's sent through it. Commands carry no extra
+  // ordering guarantees, a batch executes in the order it was packed but
+  // batches (and plain rpc_ff's) may arrive in any order. An aggregator
+  // belongs to the thread that built it, and sends as the master persona
+  // does.
+  class rpc_aggregator {
+    typedef std::chrono::steady_clock clock;
+    
+    struct batch {
+      char *buf; // null until first used
+      parcel_layout lay; // of what's in buf
+      std::size_t count_off; // n is ((uint32_t*)buf)[count_off]
+      std::uint32_t cmd_n;
+      std::size_t dirty_ix; // where in dirty_ while cmd_n != 0
+    };
+    
+    // Largest alignment a batch buffer has, commands needing more bypass
+    // the batch.
+    static constexpr std::size_t batch_align = 64;
+    
+    std::size_t cap_;
+    clock::duration delay_;
+    // bound on the header, a batch starts out this big
+    parcel_layout hdr_ub_;
+    std::vector<batch> batches_;
+    // ranks with a non-empty batch, in no order
+    std::vector<intrank_t> dirty_;
+    // when dirty_ last became non-empty, no later than any of its batches
+    // got their first command
+    clock::time_point oldest_;
+    // this thread's other aggregators
+    rpc_aggregator *next_, *prev_;
+    
+    friend void detail::rpc_aggregators_progress();
+    
+    // Returns the writer for the next command of `recipient`'s batch.
+    parcel_writer writer_(intrank_t recipient);
+    void added_(intrank_t recipient, parcel_layout lay);
+    void send_(intrank_t recipient);
+  
+  public:
+    // Batches are flushed once they would grow past `flush_bytes` (capped
+    // at the largest eager AM) or their oldest command is `flush_us`
+    // microseconds old.
+    rpc_aggregator(std::size_t flush_bytes = 16<<10, double flush_us = 100);
+    // Flushes.
+    ~rpc_aggregator();
+    
+    rpc_aggregator(rpc_aggregator const&) = delete;
+    
+    // Same as upcxx::rpc_ff(recipient, fn, args...), except the command
+    // may sit in the batch until a flush.
+    template<typename Fn, typename ...Args>
+    void rpc_ff(intrank_t recipient, Fn &&fn, Args &&...args);
+    
+    void flush(intrank_t recipient);
+    void flush();
+  };
+  
+  //////////////////////////////////////////////////////////////////////
+  
+  template<typename Fn, typename ...Args>
+  void rpc_aggregator::rpc_ff(intrank_t recipient, Fn &&fn, Args &&...args) {
+    auto fn_bound = upcxx::bind(std::forward<Fn>(fn), std::forward<Args>(args)...);
+    batch &b = this->batches_[recipient];
+    
+    parcel_layout ub = b.cmd_n == 0 ? this->hdr_ub_ : b.lay;
+    command_size_ubound(ub, fn_bound);
+    
+    if(b.cmd_n != 0 && this->cap_ < ub.size()) {
+      this->flush(recipient);
+      ub = this->hdr_ub_;
+      command_size_ubound(ub, fn_bound);
+    }
+    
+    if(this->cap_ < ub.size() || batch_align < ub.alignment()) {
+      // doesn't fit any batch
+      backend::template send_am_master<progress_level::user>(
+        recipient, std::move(fn_bound)
+      );
+      return;
+    }
+    
+    parcel_writer w = this->writer_(recipient);
+    command_pack(w, ub.size(), fn_bound);
+    this->added_(recipient, w.layout());
+  }
+}
+#endif
@@ -1,5 +1,6 @@
 #include <upcxx/rput.hpp>
 #include <upcxx/backend/gasnet/runtime_internal.hpp>
+#include <upcxx/stats.hpp>
 
 namespace gasnet = upcxx::backend::gasnet;
 
@@ -11,6 +12,9 @@ void upcxx::detail::rma_put_nb(
     gasnet::handle_cb *operation_cb
   ) {
 
+  UPCXX_STATS_ADD(rput_n, 1);
+  UPCXX_STATS_ADD(rput_bytes, size);
+  
   gex_Event_t src_h{GEX_EVENT_INVALID}, *src_ph;
 
   switch(source_mode) {
@@ -25,6 +29,22 @@ void upcxx::detail::rma_put_nb(
     break;
   }
   
+  gasnet::nbi_region_cb *region = gasnet::tl_nbi_region;
+  
+  if(region != nullptr && source_mode != rma_put_source_mode::handle) {
+    (void)gex_RMA_PutNBI(
+      gasnet::world_team, rank_d,
+      buf_d, const_cast<void*>(buf_s), size,
+      src_ph,
+      /*flags*/0
+    );
+    
+    region->cbs.push_back(operation_cb);
+    
+    gasnet::after_gasnet();
+    return;
+  }
+  
   gex_Event_t op_h = gex_RMA_PutNB(
     gasnet::world_team, rank_d,
     buf_d, const_cast<void*>(buf_s), size,
@@ -82,6 +102,9 @@ void upcxx::detail::rma_put_b(
     const void *buf_s, std::size_t size
   ) {
   
+  UPCXX_STATS_ADD(rput_n, 1);
+  UPCXX_STATS_ADD(rput_bytes, size);
+  
   (void)gex_RMA_PutBlocking(
     gasnet::world_team, rank_d,
     buf_d, const_cast<void*>(buf_s), size,
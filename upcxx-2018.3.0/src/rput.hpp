@@ -5,6 +5,8 @@
 #include <upcxx/completion.hpp>
 #include <upcxx/global_ptr.hpp>
 
+#include <cstddef>
+
 // For the time being, our implementation of put/get requires the
 // gasnet backend. Ideally we would detect gasnet via UPCXX_BACKEND_GASNET
 // and if not present, rely on a reference implementation over
@@ -129,18 +131,59 @@ namespace upcxx {
     
     template<typename FinalType, typename CxStateHere, typename CxStateRemote>
     struct rput_cb_remote<FinalType, CxStateHere, CxStateRemote, /*has_remote=*/true> {
+      bool fused = false; // remote went with the payload
+      
       void send_remote() {
         auto *cbs = static_cast<FinalType*>(this);
         
+        if(this->fused)
+          return;
+        
         backend::send_am_master<progress_level::user>(
           cbs->rank_d,
           std::move(cbs->state_remote)
         );
       }
+      
+      // Puts the payload and the remote completion in one AM long, which
+      // saves the remote event a round of waiting on the put. Returns
+      // false, having done nothing, if either is too big to be worth it.
+      bool put_fused(
+          intrank_t rank_d, void *buf_d, const void *buf_s, std::size_t size,
+          backend::gasnet::handle_cb *op_cb
+        ) {
+        auto *cbs = static_cast<FinalType*>(this);
+        
+        if(backend::gasnet::am_size_fused_max < size)
+          return false;
+        
+        parcel_layout ub;
+        command_size_ubound(ub, cbs->state_remote);
+        
+        if(backend::gasnet::am_long_cmd_max < ub.size())
+          return false;
+        
+        alignas(std::max_align_t) char cmd[backend::gasnet::am_long_cmd_max];
+        parcel_writer w{cmd};
+        command_pack(w, ub.size(), cbs->state_remote);
+        
+        this->fused = true;
+        
+        backend::gasnet::rma_put_then_am_master(
+          rank_d, buf_d, buf_s, size,
+          cmd, w.size(), w.alignment(),
+          op_cb
+        );
+        return true;
+      }
     };
     template<typename FinalType, typename CxStateHere, typename CxStateRemote>
     struct rput_cb_remote<FinalType, CxStateHere, CxStateRemote, /*has_remote=*/false> {
       void send_remote() {/*nop*/}
+      
+      bool put_fused(intrank_t, void*, const void*, std::size_t, backend::gasnet::handle_cb*) {
+        return false;
+      }
     };
     
     // rput_cb_operation: Case when the user wants synchronous operation
@@ -184,6 +227,12 @@ namespace upcxx {
         ) {
         auto *cbs = static_cast<FinalType*>(this);
         
+        // The AM long reports no source completion of its own, it only
+        // serves callers that don't want one or want it synchronously.
+        if(FinalType::source_mode != rma_put_source_mode::handle &&
+           this->put_fused(rank, buf_d, buf_s, size, this))
+          return;
+        
         rma_put_nb</*source_mode=*/FinalType::source_mode>
           (rank, buf_d, buf_s, size, cbs->source_cb(), this);
       }
@@ -0,0 +1,145 @@
+#ifndef _28a3f335_0b09_45d1_abd5_6643eaefb293
+#define _28a3f335_0b09_45d1_abd5_6643eaefb293
+
+#include <upcxx/backend.hpp>
+#include <upcxx/dist_object.hpp>
+#include <upcxx/rpc.hpp>
+#include <upcxx/team.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace upcxx {
+  namespace detail {
+    // Recursive doubling (Hillis-Steele): in round k every rank sends its
+    // partial to rank+2^k and folds in the one from rank-2^k, after which
+    // the partial covers [rank-2^(k+1)+1, rank]. ceil(log2(rank_n)) rounds.
+    template<typename T, typename Op>
+    struct scan_state {
+      team *tm;
+      Op op;
+      T partial;
+      bool exclusive;
+      T init;
+      promise<T> answer;
+
+      // fold of everything received, ie the exclusive prefix once done
+      std::unique_ptr<T> excl;
+      // inbox[k]: partial from rank-2^k, may arrive rounds early
+      std::vector<std::unique_ptr<T>> inbox;
+      int round;
+      bool sent;
+
+      // Runs rounds until one is missing its incoming partial. Deletes
+      // `this_obj` once the answer is fulfilled.
+      void advance(dist_object<scan_state> &this_obj);
+    };
+  }
+
+  // Collective over `tm`. Team rank r gets op(init, v_0, ..., v_{r-1}),
+  // rank 0 gets `init`. `op` must be associative.
+  template<typename T1, typename BinaryOp,
+           typename T = typename std::decay<T1>::type>
+  future<T> exclusive_scan(T1 &&value, BinaryOp op, T init, team &tm = upcxx::world());
+
+  // Collective over `tm`. Team rank r gets op(v_0, ..., v_r).
+  template<typename T1, typename BinaryOp,
+           typename T = typename std::decay<T1>::type>
+  future<T> inclusive_scan(T1 &&value, BinaryOp op, team &tm = upcxx::world());
+
+  namespace detail {
+    template<typename T, typename BinaryOp>
+    future<T> scan(T value, BinaryOp op, bool exclusive, T init, team &tm) {
+      int rounds = 0;
+      while((intrank_t(1) << rounds) < tm.rank_n())
+        rounds += 1;
+
+      auto *state = new dist_object<scan_state<T,BinaryOp>>(
+        scan_state<T,BinaryOp>{
+          &tm,
+          std::move(op),
+          std::move(value),
+          exclusive,
+          std::move(init),
+          promise<T>{},
+          std::unique_ptr<T>{},
+          std::vector<std::unique_ptr<T>>(rounds),
+          /*round=*/0,
+          /*sent=*/false
+        },
+        tm
+      );
+
+      future<T> result = (*state)->answer.get_future();
+
+      // This could delete `state` before it returns.
+      (*state)->advance(*state);
+
+      return result;
+    }
+
+    template<typename T, typename Op>
+    void scan_state<T,Op>::advance(dist_object<scan_state> &this_obj) {
+      intrank_t rank_me = this->tm->rank_me();
+      intrank_t rank_n = this->tm->rank_n();
+
+      while(true) {
+        intrank_t dist = intrank_t(1) << this->round;
+
+        if(rank_n <= dist) {
+          if(this->exclusive)
+            this->answer.fulfill_result(
+              this->excl ? this->op(this->init, *this->excl) : this->init
+            );
+          else
+            this->answer.fulfill_result(std::move(this->partial));
+
+          delete &this_obj;
+          return;
+        }
+
+        if(!this->sent) {
+          if(rank_me + dist < rank_n) {
+            rpc_ff((*this->tm)[rank_me + dist],
+              [](dist_object<scan_state> &this_obj, int round, T const &value) {
+                this_obj->inbox[round].reset(new T(value));
+                this_obj->advance(this_obj);
+              },
+              this_obj, this->round, this->partial
+            );
+          }
+          this->sent = true;
+        }
+
+        if(dist <= rank_me) {
+          std::unique_ptr<T> &in = this->inbox[this->round];
+          if(!in)
+            return; // resumed by the rpc delivering it
+
+          if(this->excl)
+            *this->excl = this->op(*in, *this->excl);
+          else
+            this->excl.reset(new T(*in));
+
+          this->partial = this->op(*in, this->partial);
+          in.reset();
+        }
+
+        this->round += 1;
+        this->sent = false;
+      }
+    }
+  }
+
+  template<typename T1, typename BinaryOp, typename T>
+  future<T> exclusive_scan(T1 &&value, BinaryOp op, T init, team &tm) {
+    return detail::scan<T,BinaryOp>(std::forward<T1>(value), std::move(op), true, std::move(init), tm);
+  }
+
+  template<typename T1, typename BinaryOp, typename T>
+  future<T> inclusive_scan(T1 &&value, BinaryOp op, team &tm) {
+    T init = value; // unused placeholder, T need not be default constructible
+    return detail::scan<T,BinaryOp>(std::forward<T1>(value), std::move(op), false, std::move(init), tm);
+  }
+}
+#endif
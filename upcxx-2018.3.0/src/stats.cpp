@@ -0,0 +1,19 @@
+#include <upcxx/stats.hpp>
+
+#if UPCXX_STATS_ENABLED
+  thread_local upcxx::stats_t upcxx::detail::tl_stats = {};
+#endif
+
+upcxx::stats_t upcxx::stats() {
+  #if UPCXX_STATS_ENABLED
+    return detail::tl_stats;
+  #else
+    return stats_t{};
+  #endif
+}
+
+void upcxx::stats_reset() {
+  #if UPCXX_STATS_ENABLED
+    detail::tl_stats = stats_t{};
+  #endif
+}
@@ -0,0 +1,49 @@
+#ifndef _2509c7ee_a9fa_4365_8568_017411ac7e73
+#define _2509c7ee_a9fa_4365_8568_017411ac7e73
+
+#include <cstdint>
+
+/* Communication counters. Each thread counts what it does itself. They
+ * only exist when the library is built with UPCXX_STATS=1 in the
+ * environment, otherwise UPCXX_STATS_ADD compiles to nothing and
+ * stats() reports zeros.
+ */
+
+namespace upcxx {
+  // *** not spec'd ***
+  struct stats_t {
+    // AMs from send_am_master/persona, by protocol, and their packed size
+    std::uint64_t am_eager_n, am_eager_bytes;
+    std::uint64_t am_rdzv_n, am_rdzv_bytes;
+    // rput/rget's (blocking and not) and their payload
+    std::uint64_t rput_n, rput_bytes;
+    std::uint64_t rget_n, rget_bytes;
+    // completed gasnet handles run by handle_cb_queue::burst
+    std::uint64_t handle_cb_n;
+    // incoming rpc's run out of the master's inboxes
+    std::uint64_t rpc_n;
+    // lpc's run out of the personas this thread held
+    std::uint64_t lpc_n;
+    // progress() calls, and how many of them ran nothing
+    std::uint64_t progress_n, progress_empty_n;
+  };
+  
+  // *** not spec'd ***
+  // The calling thread's counters since it started or last reset them.
+  stats_t stats();
+  void stats_reset();
+  
+  namespace detail {
+    #if UPCXX_STATS_ENABLED
+      extern thread_local stats_t tl_stats;
+    #endif
+  }
+}
+
+#if UPCXX_STATS_ENABLED
+  #define UPCXX_STATS_ADD(field, n) ((void)(::upcxx::detail::tl_stats.field += (n)))
+#else
+  #define UPCXX_STATS_ADD(field, n) ((void)0)
+#endif
+
+#endif
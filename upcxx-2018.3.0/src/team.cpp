@@ -0,0 +1,183 @@
+#include <upcxx/team.hpp>
+#include <upcxx/allreduce.hpp>
+#include <upcxx/backend/gasnet/runtime_internal.hpp>
+
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
+using upcxx::digest;
+using upcxx::intrank_t;
+using upcxx::promise;
+using upcxx::team;
+using upcxx::team_id;
+
+using namespace std;
+
+unordered_map<digest, upcxx::promise<team&>*> upcxx::detail::team_master_promises;
+
+upcxx::promise<team&>* upcxx::detail::team_promise(digest id) {
+  auto it = team_master_promises.find(id);
+  
+  if(it != team_master_promises.end())
+    return it->second;
+  
+  promise<team&> *pro = new promise<team&>;
+  team_master_promises[id] = pro;
+  return pro;
+}
+
+void upcxx::detail::team_promises_drop_unfulfilled() {
+  for(auto it = team_master_promises.begin(); it != team_master_promises.end();) {
+    if(!it->second->get_future().ready()) {
+      delete it->second;
+      it = team_master_promises.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+namespace {
+  team *world_ = nullptr;
+  team *local_team_ = nullptr;
+}
+
+constexpr intrank_t team::color_none;
+
+team::team(digest id, intrank_t rank_n, intrank_t rank_me, vector<intrank_t> world_ranks):
+  id_{id},
+  rank_n_{rank_n},
+  rank_me_{rank_me},
+  world_ranks_{std::move(world_ranks)} {
+  
+  if(rank_n_ != 0)
+    detail::team_promise(id_)->fulfill_result(*this);
+}
+
+team::team(detail::team_split_result &&r):
+  team(r.id, r.rank_n, r.rank_me, std::move(r.world_ranks)) {
+}
+
+team::team(team &parent, intrank_t color, intrank_t key):
+  team(parent.split_(color, key)) {
+}
+
+team::~team() {
+  if(rank_n_ != 0) {
+    auto it = detail::team_master_promises.find(id_);
+    UPCXX_ASSERT(it != detail::team_master_promises.end());
+    delete it->second;
+    detail::team_master_promises.erase(it);
+  }
+}
+
+intrank_t team::from_world(intrank_t world_index, intrank_t otherwise) const {
+  if(world_ranks_.empty())
+    return 0 <= world_index && world_index < rank_n_ ? world_index : otherwise;
+  
+  // members of a split team are not in world order, so scan
+  auto it = std::find(world_ranks_.begin(), world_ranks_.end(), world_index);
+  return it == world_ranks_.end() ? otherwise : intrank_t(it - world_ranks_.begin());
+}
+
+upcxx::detail::team_split_result team::split_(intrank_t color, intrank_t key) {
+  // Everyone's (color, key, team rank), concatenated over this team.
+  using entry = array<intrank_t,3>;
+  
+  vector<entry> all = upcxx::allreduce(
+    vector<entry>{entry{{color, key, rank_me_}}},
+    [](vector<entry> a, vector<entry> const &b) {
+      a.insert(a.end(), b.begin(), b.end());
+      return a;
+    },
+    *this
+  ).wait();
+  
+  // Same on every member, so members of a color agree on the new id.
+  digest id = this->next_collective_id();
+  
+  if(color == color_none)
+    return detail::team_split_result{id, 0, -1, {}};
+  
+  vector<entry> mine;
+  for(entry const &e: all) {
+    if(e[0] == color)
+      mine.push_back(e);
+  }
+  std::sort(mine.begin(), mine.end(),
+    [](entry const &a, entry const &b) {
+      return a[1] < b[1] || (a[1] == b[1] && a[2] < b[2]);
+    }
+  );
+  
+  vector<intrank_t> world_ranks(mine.size());
+  intrank_t me = -1;
+  for(size_t i=0; i < mine.size(); i++) {
+    world_ranks[i] = (*this)[mine[i][2]];
+    if(mine[i][2] == rank_me_)
+      me = intrank_t(i);
+  }
+  
+  return detail::team_split_result{
+    id.eat(uint64_t(color)), intrank_t(mine.size()), me, std::move(world_ranks)
+  };
+}
+
+team& team_id::here() const {
+  // Looks without inserting, a miss must not leave a promise behind.
+  auto it = detail::team_master_promises.find(dig_);
+  UPCXX_ASSERT(it != detail::team_master_promises.end() && it->second->get_future().ready(),
+    "Team does not exist on this rank.");
+  return it->second->get_future().result();
+}
+
+upcxx::future<team&> team_id::when_here() const {
+  return detail::team_promise(dig_)->get_future();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+team& upcxx::world() {
+  if(world_ == nullptr)
+    world_ = new team(digest{0, 0}, upcxx::rank_n(), upcxx::rank_me(), {});
+  return *world_;
+}
+
+team& upcxx::local_team() {
+  if(local_team_ == nullptr) {
+    gex_RankInfo_t *info;
+    gex_Rank_t info_n, info_me;
+    gex_System_QueryHostInfo(&info, &info_n, &info_me);
+    
+    vector<intrank_t> world_ranks(info_n);
+    for(gex_Rank_t i=0; i < info_n; i++)
+      world_ranks[i] = info[i].gex_jobrank;
+    
+    // Named after the host's first rank, no communication needed.
+    local_team_ = new team(
+      digest{0, 0}.eat(~0ull, uint64_t(world_ranks[0])),
+      intrank_t(info_n), intrank_t(info_me), std::move(world_ranks)
+    );
+  }
+  return *local_team_;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void upcxx::barrier(team &tm) {
+  if(&tm == &upcxx::world())
+    upcxx::barrier();
+  else
+    upcxx::barrier_async(tm).wait();
+}
+
+upcxx::future<> upcxx::barrier_async(team &tm) {
+  if(&tm == &upcxx::world())
+    return upcxx::barrier_async();
+  
+  // Nobody gets the reduced value before everyone has contributed.
+  return upcxx::allreduce(
+      char(0), [](char a, char) { return a; }, tm
+    ).then([](char) {});
+}
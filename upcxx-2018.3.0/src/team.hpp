@@ -0,0 +1,112 @@
+#ifndef _44ae7981_5542_4ff5_b1ee_b45fe9c4d5d0
+#define _44ae7981_5542_4ff5_b1ee_b45fe9c4d5d0
+
+#include <upcxx/backend.hpp>
+#include <upcxx/digest.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace upcxx {
+  class team;
+  
+  namespace detail {
+    // Maps from team id to `promise<team&>*`, fulfilled when the team is
+    // constructed on this rank. Master persona only.
+    extern std::unordered_map<digest, promise<team&>*> team_master_promises;
+    
+    promise<team&>* team_promise(digest id);
+    
+    // Drops the promises of teams never built here, called by finalize().
+    void team_promises_drop_unfulfilled();
+    
+    // What a split computes for the new team.
+    struct team_split_result {
+      digest id;
+      intrank_t rank_n, rank_me;
+      std::vector<intrank_t> world_ranks;
+    };
+  }
+  
+  // Names a team on every member, so that rpc's can find the receiver's
+  // instance.
+  struct team_id {
+  //private:
+    digest dig_;
+    
+  //public:
+    // The team must already exist on this rank.
+    team& here() const;
+    // Ready once the team exists on this rank. A member may see traffic
+    // for a team before it has returned from the split making it. Only
+    // members may ask, a promise for a team never built here lingers
+    // until finalize().
+    future<team&> when_here() const;
+    
+    friend bool operator==(team_id a, team_id b) { return a.dig_ == b.dig_; }
+    friend bool operator!=(team_id a, team_id b) { return a.dig_ != b.dig_; }
+  };
+  
+  class team {
+    digest id_;
+    // Collective counter for naming dist_object's (and the collectives
+    // built on them) created over this team.
+    std::uint64_t coll_counter_ = 0;
+    intrank_t rank_n_, rank_me_;
+    // World rank of each member, empty for the world team.
+    std::vector<intrank_t> world_ranks_;
+    
+    detail::team_split_result split_(intrank_t color, intrank_t key);
+    team(detail::team_split_result &&r);
+    
+  public:
+    static constexpr intrank_t color_none = -0xf00d;
+    
+    // *** not spec'd *** teams are made by world(), local_team() and the
+    // splitting constructor
+    team(digest id, intrank_t rank_n, intrank_t rank_me, std::vector<intrank_t> world_ranks);
+    
+    // *** not spec'd *** stands in for the spec's `parent.split(color, key)`.
+    // Collective over `parent`. Members passing the same color form a new
+    // team, ranked by key then by rank in `parent`. Members passing
+    // color_none get an empty team (rank_n() == 0).
+    team(team &parent, intrank_t color, intrank_t key);
+    
+    // Teams don't move: dist_object's, collectives and when_here() futures
+    // refer to them by address.
+    team(team const&) = delete;
+    team(team &&) = delete;
+    ~team();
+    
+    intrank_t rank_n() const { return rank_n_; }
+    intrank_t rank_me() const { return rank_me_; }
+    
+    // World rank of team member `peer`.
+    intrank_t operator[](intrank_t peer) const {
+      UPCXX_ASSERT(0 <= peer && peer < rank_n_);
+      return world_ranks_.empty() ? peer : world_ranks_[peer];
+    }
+    
+    // Team rank of world rank `world_index`, `otherwise` if not a member.
+    intrank_t from_world(intrank_t world_index, intrank_t otherwise = -1) const;
+    
+    team_id id() const { return team_id{id_}; }
+    
+    // *** not spec'd *** name for the next collective object on this team,
+    // members must ask in the same order.
+    digest next_collective_id() {
+      return id_.eat(coll_counter_++);
+    }
+  };
+  
+  // Both are built by init().
+  team& world();
+  
+  // Ranks sharing this rank's host.
+  team& local_team();
+  
+  void barrier(team &tm);
+  future<> barrier_async(team &tm);
+}
+#endif
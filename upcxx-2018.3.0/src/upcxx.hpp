@@ -12,9 +12,20 @@
 #include <upcxx/global_ptr.hpp>
 #include <upcxx/rget.hpp>
 #include <upcxx/rput.hpp>
+#include <upcxx/rma_region.hpp>
+#include <upcxx/rpc_aggregator.hpp>
+#include <upcxx/vis.hpp>
+#include <upcxx/progress_thread.hpp>
 //#include <upcxx/wait.hpp>
 #include <upcxx/atomic.hpp>
 #include <upcxx/broadcast.hpp>
+#include <upcxx/broadcast_bulk.hpp>
+#include <upcxx/coll_handle.hpp>
 #include <upcxx/allreduce.hpp>
+#include <upcxx/allreduce_bulk.hpp>
+#include <upcxx/rma_coll.hpp>
+#include <upcxx/scan.hpp>
+#include <upcxx/stats.hpp>
+#include <upcxx/team.hpp>
 
 #endif
@@ -0,0 +1,60 @@
+#include <upcxx/vis.hpp>
+#include <upcxx/backend/gasnet/runtime_internal.hpp>
+#include <upcxx/stats.hpp>
+
+namespace gasnet = upcxx::backend::gasnet;
+
+bool upcxx::detail::rma_frags_begin() {
+  if(gasnet::tl_nbi_region != nullptr)
+    return false;
+  
+  gex_NBI_BeginAccessRegion(/*flags*/0);
+  return true;
+}
+
+void upcxx::detail::rma_frags_put(
+    intrank_t rank_d, void *buf_d,
+    const void *buf_s, std::size_t size,
+    bool source_now
+  ) {
+  
+  UPCXX_STATS_ADD(rput_n, 1);
+  UPCXX_STATS_ADD(rput_bytes, size);
+  
+  (void)gex_RMA_PutNBI(
+    gasnet::world_team, rank_d,
+    buf_d, const_cast<void*>(buf_s), size,
+    source_now ? GEX_EVENT_NOW : GEX_EVENT_DEFER,
+    /*flags*/0
+  );
+}
+
+void upcxx::detail::rma_frags_get(
+    void *buf_d,
+    intrank_t rank_s, const void *buf_s,
+    std::size_t size
+  ) {
+  
+  UPCXX_STATS_ADD(rget_n, 1);
+  UPCXX_STATS_ADD(rget_bytes, size);
+  
+  (void)gex_RMA_GetNBI(
+    gasnet::world_team,
+    buf_d, rank_s, const_cast<void*>(buf_s), size,
+    /*flags*/0
+  );
+}
+
+void upcxx::detail::rma_frags_end(bool own_region, gasnet::handle_cb *cb) {
+  if(own_region) {
+    gex_Event_t h = gex_NBI_EndAccessRegion(/*flags*/0);
+    cb->handle = reinterpret_cast<uintptr_t>(h);
+    gasnet::register_cb(cb);
+  }
+  else {
+    // The enclosing rma_region's event covers our fragments too.
+    gasnet::tl_nbi_region->cbs.push_back(cb);
+  }
+  
+  gasnet::after_gasnet();
+}
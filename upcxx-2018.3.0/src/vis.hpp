@@ -0,0 +1,706 @@
+#ifndef _d4fef004_f5aa_4d69_b53a_7cdbc1d3890b
+#define _d4fef004_f5aa_4d69_b53a_7cdbc1d3890b
+
+#include <upcxx/backend.hpp>
+#include <upcxx/bind.hpp>
+#include <upcxx/completion.hpp>
+#include <upcxx/global_ptr.hpp>
+#include <upcxx/rget.hpp>
+#include <upcxx/rput.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+/* Non-contiguous rput/rget. The transfer is cut into fragments, each
+ * one a contiguous piece of both the source and the destination, which
+ * are issued as NBI operations inside one access region. The region's
+ * single event stands for all of them, so a call costs one callback
+ * however many fragments it has.
+ *
+ * Strided sections whose fragments would be smaller than
+ * vis_pack_frag_max are packed instead: the initiator packs its side
+ * into one buffer, which travels as an internal-level active message
+ * and gets unpacked on the other side (for a get, the target packs and
+ * replies). That takes one message each way whatever the shape, but
+ * needs the target to make progress, and such a transfer does not join
+ * an enclosing rma_region.
+ *
+ * All the remote runs of a call must live on the same rank.
+ */
+
+namespace upcxx {
+  namespace detail {
+    // Opens an NBI access region for the fragments of one call, unless
+    // the thread is already in a upcxx::rma_region. Returns whether it
+    // opened one.
+    bool rma_frags_begin();
+    
+    void rma_frags_put(
+      intrank_t rank_d, void *buf_d,
+      const void *buf_s, std::size_t size,
+      bool source_now
+    );
+    void rma_frags_get(
+      void *buf_d,
+      intrank_t rank_s, const void *buf_s,
+      std::size_t size
+    );
+    
+    // `cb` fires once every fragment since rma_frags_begin() completed.
+    void rma_frags_end(bool own_region, backend::gasnet::handle_cb *cb);
+    
+    ////////////////////////////////////////////////////////////////////
+    
+    template<typename CxStateHere, typename CxStateRemote>
+    struct vis_cb final:
+      rget_cb_remote<CxStateRemote>,
+      backend::gasnet::handle_cb {
+      
+      CxStateHere state_here;
+      
+      vis_cb(intrank_t rank, CxStateHere state_here, CxStateRemote state_remote):
+        rget_cb_remote<CxStateRemote>{rank, std::move(state_remote)},
+        state_here{std::move(state_here)} {
+      }
+      
+      void complete() {
+        this->send_remote();
+        this->state_here.template operator()<source_cx_event>();
+        this->state_here.template operator()<operation_cx_event>();
+      }
+      
+      void execute_and_delete(backend::gasnet::handle_cb_successor) {
+        this->complete();
+        delete this;
+      }
+    };
+    
+    template<typename Cxs>
+    using vis_return_t = typename completions_returner<
+        /*EventPredicate=*/event_is_here,
+        /*EventValues=*/rput_event_values,
+        Cxs
+      >::return_t;
+    
+    // Runs `walk(xfer)`, which calls xfer(buf_d, buf_s, size) once per
+    // fragment, as one operation with `rank` as the remote end.
+    template<bool is_put, typename Cxs, typename Walk>
+    vis_return_t<Cxs> vis_initiate(intrank_t rank, Cxs cxs, Walk &&walk) {
+      UPCXX_ASSERT_ALWAYS((completions_has_event<Cxs, operation_cx_event>::value));
+      
+      using cxs_here_t = completions_state<
+        /*EventPredicate=*/event_is_here,
+        /*EventValues=*/rput_event_values,
+        Cxs>;
+      using cxs_remote_t = completions_state<
+        /*EventPredicate=*/event_is_remote,
+        /*EventValues=*/rput_event_values,
+        Cxs>;
+      using returner_t = completions_returner<
+        /*EventPredicate=*/event_is_here,
+        /*EventValues=*/rput_event_values,
+        Cxs>;
+      using cb_t = vis_cb<cxs_here_t, cxs_remote_t>;
+      
+      if(completions_is_event_sync<Cxs, operation_cx_event>::value) {
+        // Blocking fragments, everything is done on return.
+        cb_t cb_static{rank, cxs_here_t{std::move(cxs)}, cxs_remote_t{std::move(cxs)}};
+        returner_t returner{cb_static.state_here};
+        
+        walk([=](void *buf_d, const void *buf_s, std::size_t size) {
+          if(is_put)
+            rma_put_b(rank, buf_d, buf_s, size);
+          else
+            rma_get_b(buf_d, rank, buf_s, size);
+        });
+        
+        cb_static.complete();
+        
+        return returner();
+      }
+      
+      constexpr bool source_now = is_put &&
+        completions_is_event_sync<Cxs, source_cx_event>::value;
+      
+      cb_t *cb = new cb_t{rank, cxs_here_t{std::move(cxs)}, cxs_remote_t{std::move(cxs)}};
+      returner_t returner{cb->state_here};
+      
+      bool own_region = rma_frags_begin();
+      
+      walk([=](void *buf_d, const void *buf_s, std::size_t size) {
+        if(is_put)
+          rma_frags_put(rank, buf_d, buf_s, size, source_now);
+        else
+          rma_frags_get(buf_d, rank, buf_s, size);
+      });
+      
+      // Asynchronous source completion is reported with operation
+      // completion, the region has no earlier event for it.
+      if(source_now)
+        cb->state_here.template operator()<source_cx_event>();
+      
+      rma_frags_end(own_region, cb);
+      
+      return returner();
+    }
+    
+    ////////////////////////////////////////////////////////////////////
+    // Fragment walks
+    
+    inline char* vis_addr(const void *p) {
+      return static_cast<char*>(const_cast<void*>(p));
+    }
+    template<typename T>
+    char* vis_addr(global_ptr<T> gp) {
+      return reinterpret_cast<char*>(gp.raw_ptr_);
+    }
+    
+    // Same, for a run of a call whose remote end is `rank`.
+    inline char* vis_run_addr(const void *p, intrank_t) {
+      return vis_addr(p);
+    }
+    template<typename T>
+    char* vis_run_addr(global_ptr<T> gp, intrank_t rank) {
+      UPCXX_ASSERT(gp.rank_ == rank,
+        "All the remote runs of a call must be on the same rank, "
+        "got rank "<<gp.rank_<<" after rank "<<rank<<"."
+      );
+      return vis_addr(gp);
+    }
+    
+    // Pairs up the runs handed out by `next_src` and `next_dst`, which
+    // set their (pointer, bytes) arguments and return false once out of
+    // runs. A fragment ends wherever either run does.
+    template<typename NextSrc, typename NextDst, typename Xfer>
+    void vis_walk_runs(NextSrc &&next_src, NextDst &&next_dst, Xfer &&xfer) {
+      char *s = nullptr, *d = nullptr;
+      std::size_t s_n = 0, d_n = 0; // bytes left in the current runs
+      
+      while(true) {
+        while(s_n == 0 && next_src(s, s_n));
+        while(d_n == 0 && next_dst(d, d_n));
+        
+        if(s_n == 0 || d_n == 0) {
+          UPCXX_ASSERT(s_n == 0 && d_n == 0,
+            "Source and destination runs differ in total length."
+          );
+          return;
+        }
+        
+        std::size_t n = std::min(s_n, d_n);
+        xfer(d, s, n);
+        s += n; s_n -= n;
+        d += n; d_n -= n;
+      }
+    }
+    
+    // Runs given as (pointer, element count) pairs.
+    template<typename T, typename Iter>
+    struct vis_irregular_runs {
+      Iter it, end;
+      intrank_t rank; // of the call
+      
+      bool operator()(char *&p, std::size_t &n) {
+        if(it == end)
+          return false;
+        p = vis_run_addr(std::get<0>(*it), rank);
+        n = std::get<1>(*it)*sizeof(T);
+        ++it;
+        return true;
+      }
+    };
+    
+    // Runs given as pointers, all `len` elements long.
+    template<typename T, typename Iter>
+    struct vis_regular_runs {
+      Iter it, end;
+      std::size_t len;
+      intrank_t rank; // of the call
+      
+      bool operator()(char *&p, std::size_t &n) {
+        if(it == end)
+          return false;
+        p = vis_run_addr(*it, rank);
+        n = len*sizeof(T);
+        ++it;
+        return true;
+      }
+    };
+    
+    template<std::size_t Dim>
+    std::size_t vis_strided_bytes(
+        std::array<std::size_t,Dim> const &extents,
+        std::size_t elt_size
+      ) {
+      std::size_t total = elt_size;
+      for(std::size_t k=0; k != Dim; k++)
+        total *= extents[k];
+      return total;
+    }
+    
+    // Leading dimensions of a strided section that are contiguous on both
+    // ends merge into one fragment of `run` bytes, the walk covers
+    // dimensions `lo` and up. Returns the whole section's bytes.
+    template<std::size_t Dim>
+    std::size_t vis_strided_frags(
+        std::array<std::ptrdiff_t,Dim> const &s_strides,
+        std::array<std::ptrdiff_t,Dim> const &d_strides,
+        std::array<std::size_t,Dim> const &extents,
+        std::size_t elt_size,
+        std::size_t &lo, std::size_t &run
+      ) {
+      std::size_t total = vis_strided_bytes<Dim>(extents, elt_size);
+      
+      lo = 0;
+      run = elt_size;
+      while(lo != Dim &&
+            s_strides[lo] == std::ptrdiff_t(run) &&
+            d_strides[lo] == std::ptrdiff_t(run)) {
+        run *= extents[lo];
+        lo += 1;
+      }
+      
+      return total;
+    }
+    
+    // Strides of the section packed densely, dimension 0 fastest.
+    template<std::size_t Dim>
+    std::array<std::ptrdiff_t,Dim> vis_dense_strides(
+        std::array<std::size_t,Dim> const &extents,
+        std::size_t elt_size
+      ) {
+      std::array<std::ptrdiff_t,Dim> strides;
+      std::ptrdiff_t stride = elt_size;
+      for(std::size_t k=0; k != Dim; k++) {
+        strides[k] = stride;
+        stride *= extents[k];
+      }
+      return strides;
+    }
+    
+    struct vis_memcpy {
+      void operator()(char *d, char *s, std::size_t n) const {
+        std::memcpy(d, s, n);
+      }
+    };
+    
+    // Visits every element of a Dim-dimensional section, strides in
+    // bytes, one fragment per vis_strided_frags() run.
+    template<std::size_t Dim, typename Xfer>
+    void vis_walk_strided(
+        char *s, std::array<std::ptrdiff_t,Dim> const &s_strides,
+        char *d, std::array<std::ptrdiff_t,Dim> const &d_strides,
+        std::array<std::size_t,Dim> const &extents,
+        std::size_t elt_size,
+        Xfer &&xfer
+      ) {
+      for(std::size_t k=0; k != Dim; k++) {
+        if(extents[k] == 0)
+          return;
+      }
+      
+      std::size_t lo, run;
+      vis_strided_frags<Dim>(s_strides, d_strides, extents, elt_size, lo, run);
+      
+      std::array<std::size_t,Dim> idx{};
+      
+      while(true) {
+        xfer(d, s, run);
+        
+        std::size_t k = lo;
+        for(; k != Dim; k++) {
+          if(++idx[k] != extents[k]) {
+            s += s_strides[k];
+            d += d_strides[k];
+            break;
+          }
+          idx[k] = 0;
+          s -= s_strides[k]*std::ptrdiff_t(extents[k]-1);
+          d -= d_strides[k]*std::ptrdiff_t(extents[k]-1);
+        }
+        
+        if(k == Dim)
+          return;
+      }
+    }
+    
+    template<typename NextSrc, typename NextDst>
+    struct vis_runs_walk {
+      NextSrc next_src;
+      NextDst next_dst;
+      
+      template<typename Xfer>
+      void operator()(Xfer &&xfer) {
+        vis_walk_runs(next_src, next_dst, xfer);
+      }
+    };
+    
+    template<std::size_t Dim>
+    struct vis_strided_walk {
+      char *s;
+      std::array<std::ptrdiff_t,Dim> const &s_strides;
+      char *d;
+      std::array<std::ptrdiff_t,Dim> const &d_strides;
+      std::array<std::size_t,Dim> const &extents;
+      std::size_t elt_size;
+      
+      template<typename Xfer>
+      void operator()(Xfer &&xfer) {
+        vis_walk_strided<Dim>(s, s_strides, d, d_strides, extents, elt_size, xfer);
+      }
+    };
+    
+    ////////////////////////////////////////////////////////////////////
+    // Packed strided transfers
+    
+    // Smallest fragment worth its own network operation.
+    constexpr std::size_t vis_pack_frag_max = 256;
+    
+    // Back on the initiator, the transfer is done. `done` is set instead
+    // when the initiator blocks for it.
+    template<typename Cb>
+    struct vis_packed_done {
+      Cb *cb;
+      bool *done;
+      
+      void operator()() {
+        if(done != nullptr)
+          *done = true;
+        else {
+          cb->complete();
+          delete cb;
+        }
+      }
+    };
+    
+    // Runs on the target of a put with the packed source.
+    template<std::size_t Dim, typename Cb>
+    struct vis_packed_put {
+      char *d;
+      std::array<std::ptrdiff_t,Dim> d_strides;
+      std::array<std::size_t,Dim> extents;
+      std::size_t elt_size;
+      intrank_t initiator;
+      persona *initiator_persona;
+      vis_packed_done<Cb> done;
+      
+      void operator()(std::vector<char> const &buf) {
+        vis_walk_strided<Dim>(
+          const_cast<char*>(buf.data()), vis_dense_strides<Dim>(extents, elt_size),
+          d, d_strides, extents, elt_size, vis_memcpy{}
+        );
+        backend::send_am_persona<progress_level::internal>(
+          initiator, initiator_persona, done
+        );
+      }
+    };
+    
+    // Runs on the initiator of a get with the packed source.
+    template<std::size_t Dim, typename Cb>
+    struct vis_packed_got {
+      char *d;
+      std::array<std::ptrdiff_t,Dim> d_strides;
+      std::array<std::size_t,Dim> extents;
+      std::size_t elt_size;
+      vis_packed_done<Cb> done;
+      
+      void operator()(std::vector<char> const &buf) {
+        vis_walk_strided<Dim>(
+          const_cast<char*>(buf.data()), vis_dense_strides<Dim>(extents, elt_size),
+          d, d_strides, extents, elt_size, vis_memcpy{}
+        );
+        done();
+      }
+    };
+    
+    // Runs on the target of a get, packs the source and replies.
+    template<std::size_t Dim, typename Cb>
+    struct vis_packed_get {
+      char *s;
+      std::array<std::ptrdiff_t,Dim> s_strides;
+      intrank_t initiator;
+      persona *initiator_persona;
+      vis_packed_got<Dim,Cb> got;
+      
+      void operator()() {
+        std::vector<char> buf(vis_strided_bytes<Dim>(got.extents, got.elt_size));
+        vis_walk_strided<Dim>(
+          s, s_strides,
+          buf.data(), vis_dense_strides<Dim>(got.extents, got.elt_size),
+          got.extents, got.elt_size, vis_memcpy{}
+        );
+        backend::send_am_persona<progress_level::internal>(
+          initiator, initiator_persona,
+          upcxx::bind(got, std::move(buf))
+        );
+      }
+    };
+    
+    // vis_initiate() for a strided section moved in one packed message.
+    template<bool is_put, std::size_t Dim, typename Cxs>
+    vis_return_t<Cxs> vis_initiate_packed(
+        intrank_t rank, Cxs cxs,
+        char *s, std::array<std::ptrdiff_t,Dim> const &s_strides,
+        char *d, std::array<std::ptrdiff_t,Dim> const &d_strides,
+        std::array<std::size_t,Dim> const &extents,
+        std::size_t elt_size
+      ) {
+      UPCXX_ASSERT_ALWAYS((completions_has_event<Cxs, operation_cx_event>::value));
+      
+      using cxs_here_t = completions_state<
+        /*EventPredicate=*/event_is_here,
+        /*EventValues=*/rput_event_values,
+        Cxs>;
+      using cxs_remote_t = completions_state<
+        /*EventPredicate=*/event_is_remote,
+        /*EventValues=*/rput_event_values,
+        Cxs>;
+      using returner_t = completions_returner<
+        /*EventPredicate=*/event_is_here,
+        /*EventValues=*/rput_event_values,
+        Cxs>;
+      using cb_t = vis_cb<cxs_here_t, cxs_remote_t>;
+      
+      persona *me = &upcxx::current_persona();
+      
+      auto send = [&](vis_packed_done<cb_t> done) {
+        if(is_put) {
+          std::vector<char> buf(vis_strided_bytes<Dim>(extents, elt_size));
+          vis_walk_strided<Dim>(
+            s, s_strides,
+            buf.data(), vis_dense_strides<Dim>(extents, elt_size),
+            extents, elt_size, vis_memcpy{}
+          );
+          backend::send_am_master<progress_level::internal>(rank,
+            upcxx::bind(
+              vis_packed_put<Dim,cb_t>{
+                d, d_strides, extents, elt_size, backend::rank_me, me, done
+              },
+              std::move(buf)
+            )
+          );
+        }
+        else {
+          backend::send_am_master<progress_level::internal>(rank,
+            vis_packed_get<Dim,cb_t>{
+              s, s_strides, backend::rank_me, me,
+              vis_packed_got<Dim,cb_t>{d, d_strides, extents, elt_size, done}
+            }
+          );
+        }
+      };
+      
+      // The source is packed before we return, asynchronous source
+      // completion is still reported with operation completion.
+      
+      if(completions_is_event_sync<Cxs, operation_cx_event>::value) {
+        cb_t cb_static{rank, cxs_here_t{std::move(cxs)}, cxs_remote_t{std::move(cxs)}};
+        returner_t returner{cb_static.state_here};
+        
+        bool done = false;
+        send(vis_packed_done<cb_t>{nullptr, &done});
+        while(!done)
+          upcxx::progress(progress_level::internal);
+        
+        cb_static.complete();
+        return returner();
+      }
+      
+      cb_t *cb = new cb_t{rank, cxs_here_t{std::move(cxs)}, cxs_remote_t{std::move(cxs)}};
+      returner_t returner{cb->state_here};
+      
+      send(vis_packed_done<cb_t>{cb, nullptr});
+      
+      return returner();
+    }
+    
+    // Strided transfer by fragments, or packed if they'd be small.
+    template<bool is_put, std::size_t Dim, typename Cxs>
+    vis_return_t<Cxs> vis_strided(
+        intrank_t rank, Cxs cxs,
+        char *s, std::array<std::ptrdiff_t,Dim> const &s_strides,
+        char *d, std::array<std::ptrdiff_t,Dim> const &d_strides,
+        std::array<std::size_t,Dim> const &extents,
+        std::size_t elt_size
+      ) {
+      std::size_t lo, run;
+      std::size_t total = vis_strided_frags<Dim>(s_strides, d_strides, extents, elt_size, lo, run);
+      
+      if(run < vis_pack_frag_max && run < total)
+        return vis_initiate_packed<is_put,Dim>(
+          rank, std::move(cxs), s, s_strides, d, d_strides, extents, elt_size
+        );
+      
+      return vis_initiate<is_put>(
+        rank, std::move(cxs),
+        vis_strided_walk<Dim>{s, s_strides, d, d_strides, extents, elt_size}
+      );
+    }
+    
+    template<typename NextSrc, typename NextDst>
+    vis_runs_walk<NextSrc,NextDst> vis_runs(NextSrc next_src, NextDst next_dst) {
+      return vis_runs_walk<NextSrc,NextDst>{next_src, next_dst};
+    }
+    
+    // Rank of the first global run, we don't touch memory if there is
+    // none. The runs check the rest against it as they are walked.
+    template<typename Iter>
+    intrank_t vis_rank(Iter it, Iter end) {
+      return it == end ? backend::rank_me : std::get<0>(*it).rank_;
+    }
+    template<typename Iter>
+    intrank_t vis_regular_rank(Iter it, Iter end) {
+      return it == end ? backend::rank_me : (*it).rank_;
+    }
+  }
+  
+  //////////////////////////////////////////////////////////////////////
+  // rput_irregular / rget_irregular: runs are (pointer, element count)
+  // pairs. Source and destination may be cut differently, but must
+  // hold the same number of elements.
+  
+  template<typename SrcIter, typename DestIter,
+           typename Cxs = completions<future_cx<operation_cx_event>>>
+  detail::vis_return_t<Cxs> rput_irregular(
+      SrcIter src_runs_begin, SrcIter src_runs_end,
+      DestIter dest_runs_begin, DestIter dest_runs_end,
+      Cxs cxs = completions<future_cx<operation_cx_event>>{{}}
+    ) {
+    using T = typename std::decay<
+        decltype(std::get<0>(*dest_runs_begin))
+      >::type::element_type;
+    
+    intrank_t rank = detail::vis_rank(dest_runs_begin, dest_runs_end);
+    
+    return detail::vis_initiate</*is_put=*/true>(
+      rank,
+      std::move(cxs),
+      detail::vis_runs(
+        detail::vis_irregular_runs<T,SrcIter>{src_runs_begin, src_runs_end, rank},
+        detail::vis_irregular_runs<T,DestIter>{dest_runs_begin, dest_runs_end, rank}
+      )
+    );
+  }
+  
+  template<typename SrcIter, typename DestIter,
+           typename Cxs = completions<future_cx<operation_cx_event>>>
+  detail::vis_return_t<Cxs> rget_irregular(
+      SrcIter src_runs_begin, SrcIter src_runs_end,
+      DestIter dest_runs_begin, DestIter dest_runs_end,
+      Cxs cxs = completions<future_cx<operation_cx_event>>{{}}
+    ) {
+    using T = typename std::decay<
+        decltype(std::get<0>(*src_runs_begin))
+      >::type::element_type;
+    
+    intrank_t rank = detail::vis_rank(src_runs_begin, src_runs_end);
+    
+    return detail::vis_initiate</*is_put=*/false>(
+      rank,
+      std::move(cxs),
+      detail::vis_runs(
+        detail::vis_irregular_runs<T,SrcIter>{src_runs_begin, src_runs_end, rank},
+        detail::vis_irregular_runs<T,DestIter>{dest_runs_begin, dest_runs_end, rank}
+      )
+    );
+  }
+  
+  //////////////////////////////////////////////////////////////////////
+  // rput_regular / rget_regular: runs are pointers, every source run
+  // `src_run_length` elements long and every destination run
+  // `dest_run_length`.
+  
+  template<typename SrcIter, typename DestIter,
+           typename Cxs = completions<future_cx<operation_cx_event>>>
+  detail::vis_return_t<Cxs> rput_regular(
+      SrcIter src_runs_begin, SrcIter src_runs_end,
+      std::size_t src_run_length,
+      DestIter dest_runs_begin, DestIter dest_runs_end,
+      std::size_t dest_run_length,
+      Cxs cxs = completions<future_cx<operation_cx_event>>{{}}
+    ) {
+    using T = typename std::decay<decltype(*dest_runs_begin)>::type::element_type;
+    
+    intrank_t rank = detail::vis_regular_rank(dest_runs_begin, dest_runs_end);
+    
+    return detail::vis_initiate</*is_put=*/true>(
+      rank,
+      std::move(cxs),
+      detail::vis_runs(
+        detail::vis_regular_runs<T,SrcIter>{src_runs_begin, src_runs_end, src_run_length, rank},
+        detail::vis_regular_runs<T,DestIter>{dest_runs_begin, dest_runs_end, dest_run_length, rank}
+      )
+    );
+  }
+  
+  template<typename SrcIter, typename DestIter,
+           typename Cxs = completions<future_cx<operation_cx_event>>>
+  detail::vis_return_t<Cxs> rget_regular(
+      SrcIter src_runs_begin, SrcIter src_runs_end,
+      std::size_t src_run_length,
+      DestIter dest_runs_begin, DestIter dest_runs_end,
+      std::size_t dest_run_length,
+      Cxs cxs = completions<future_cx<operation_cx_event>>{{}}
+    ) {
+    using T = typename std::decay<decltype(*src_runs_begin)>::type::element_type;
+    
+    intrank_t rank = detail::vis_regular_rank(src_runs_begin, src_runs_end);
+    
+    return detail::vis_initiate</*is_put=*/false>(
+      rank,
+      std::move(cxs),
+      detail::vis_runs(
+        detail::vis_regular_runs<T,SrcIter>{src_runs_begin, src_runs_end, src_run_length, rank},
+        detail::vis_regular_runs<T,DestIter>{dest_runs_begin, dest_runs_end, dest_run_length, rank}
+      )
+    );
+  }
+  
+  //////////////////////////////////////////////////////////////////////
+  // rput_strided / rget_strided: a Dim-dimensional section of
+  // `extents` elements, element i at base + sum(i[k]*strides[k]) with
+  // strides in bytes. Dimension 0 should be the fastest varying.
+  
+  template<std::size_t Dim, typename T,
+           typename Cxs = completions<future_cx<operation_cx_event>>>
+  detail::vis_return_t<Cxs> rput_strided(
+      T const *src_base,
+      std::array<std::ptrdiff_t,Dim> const &src_strides,
+      global_ptr<T> dest_base,
+      std::array<std::ptrdiff_t,Dim> const &dest_strides,
+      std::array<std::size_t,Dim> const &extents,
+      Cxs cxs = completions<future_cx<operation_cx_event>>{{}}
+    ) {
+    return detail::vis_strided</*is_put=*/true,Dim>(
+      dest_base.rank_,
+      std::move(cxs),
+      detail::vis_addr(src_base), src_strides,
+      detail::vis_addr(dest_base), dest_strides,
+      extents, sizeof(T)
+    );
+  }
+  
+  template<std::size_t Dim, typename T,
+           typename Cxs = completions<future_cx<operation_cx_event>>>
+  detail::vis_return_t<Cxs> rget_strided(
+      global_ptr<T> src_base,
+      std::array<std::ptrdiff_t,Dim> const &src_strides,
+      T *dest_base,
+      std::array<std::ptrdiff_t,Dim> const &dest_strides,
+      std::array<std::size_t,Dim> const &extents,
+      Cxs cxs = completions<future_cx<operation_cx_event>>{{}}
+    ) {
+    return detail::vis_strided</*is_put=*/false,Dim>(
+      src_base.rank_,
+      std::move(cxs),
+      detail::vis_addr(src_base), src_strides,
+      detail::vis_addr(dest_base), dest_strides,
+      extents, sizeof(T)
+    );
+  }
+}
+#endif
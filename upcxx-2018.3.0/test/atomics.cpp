@@ -8,6 +8,7 @@
 #include <upcxx/rget.hpp>
 #include <upcxx/rput.hpp>
 #include <upcxx/atomic.hpp>
+#include <upcxx/allreduce.hpp>
 
 #include "util.hpp"
 
@@ -85,6 +86,45 @@ void test_put_get(void) {
     barrier();
 }
 
+void test_atomic_domain(void) {
+    using upcxx::atomic_op;
+    upcxx::atomic_domain<int64_t> ad({atomic_op::load, atomic_op::store, atomic_op::fetch_add,
+                                      atomic_op::compare_exchange, atomic_op::fetch_max,
+                                      atomic_op::bit_or});
+    if (rank_me() == 0) {
+        cout << "Test atomic_domain: expect value " << rank_n() * ITERS << endl;
+        ad.store(target_counter, (int64_t)0, memory_order_relaxed).wait();
+    }
+    barrier();
+
+    for (int i = 0; i < ITERS; i++) {
+        auto prev = ad.fetch_add(target_counter, 1, memory_order_relaxed).wait();
+        UPCXX_ASSERT_ALWAYS(prev >= 0 && prev < rank_n() * ITERS, "fetch_add result out of range");
+    }
+    barrier();
+    UPCXX_ASSERT_ALWAYS(ad.load(target_counter, memory_order_acquire).wait() == rank_n() * ITERS,
+                        "incorrect final value for the counter");
+    barrier();
+
+    // exactly one rank wins the swap from the final count
+    int64_t old = ad.compare_exchange(target_counter, rank_n() * ITERS, -1 - rank_me(), memory_order_acq_rel).wait();
+    int won = old == rank_n() * ITERS;
+    int winners = upcxx::allreduce(won, [](int a, int b) { return a + b; }).wait();
+    UPCXX_ASSERT_ALWAYS(winners == 1, "compare_exchange must succeed on exactly one rank");
+
+    if (rank_me() == 0)
+        ad.store(target_counter, (int64_t)0, memory_order_relaxed).wait();
+    barrier();
+    ad.fetch_max(target_counter, rank_me(), memory_order_relaxed).wait();
+    ad.bit_or(target_counter, (int64_t)1 << 62, memory_order_relaxed).wait();
+    barrier();
+    UPCXX_ASSERT_ALWAYS(ad.load(target_counter, memory_order_relaxed).wait() == (rank_n() - 1 | (int64_t)1 << 62),
+                        "incorrect fetch_max/bit_or result");
+    barrier();
+
+    ad.destroy();
+}
+
 int main(int argc, char **argv) {
     upcxx::init();
 
@@ -100,6 +140,7 @@ int main(int argc, char **argv) {
     test_fetch_add(false);
     test_fetch_add(true);
     test_put_get();
+    test_atomic_domain();
 
     print_test_success();
     
@@ -1,7 +1,14 @@
 #include <iostream>
+#include <vector>
 #include <upcxx/backend.hpp>
 #include <upcxx/allreduce.hpp>
+#include <upcxx/allreduce_bulk.hpp>
 #include <upcxx/broadcast.hpp>
+#include <upcxx/broadcast_bulk.hpp>
+#include <upcxx/coll_handle.hpp>
+#include <upcxx/rma_coll.hpp>
+#include <upcxx/scan.hpp>
+#include <upcxx/rpc.hpp>
 
 #include "util.hpp"
 
@@ -23,6 +30,20 @@ int main() {
   }
   if (!upcxx::rank_me()) cout << "broadcast test: SUCCESS" << endl;
 
+  // array broadcast, through the pipelined tree and scatter + allgather
+  for (size_t n : {size_t(3), size_t(50000), size_t(300000)}) {
+      int root = upcxx::rank_n() - 1;
+      vector<int> buf(n, -1);
+      if (upcxx::rank_me() == root)
+          for (size_t i = 0; i < n; i++)
+              buf[i] = i;
+      upcxx::broadcast(buf.data(), n, root).wait();
+      for (size_t i = 0; i < n; i++)
+          UPCXX_ASSERT_ALWAYS(buf[i] == int(i), "Wrong element from array broadcast");
+  }
+  upcxx::barrier();
+  if (!upcxx::rank_me()) cout << "array broadcast test: SUCCESS" << endl;
+
   auto fut2 = upcxx::allreduce(tosend, plus<int>());
   int recv2 = fut2.wait();
   int expected_val = upcxx::rank_n() * (upcxx::rank_n() - 1) / 2;
@@ -30,6 +51,107 @@ int main() {
   upcxx::barrier();
   if (!upcxx::rank_me()) cout << "allreduce test: SUCCESS" << endl;
 
+  // array allreduce, small enough for the pipelined tree and large
+  // enough for reduce-scatter + allgather
+  for (size_t n : {size_t(1), size_t(5000), size_t(100000)}) {
+      vector<long> src(n), dst(n);
+      for (size_t i = 0; i < n; i++)
+          src[i] = upcxx::rank_me() + i;
+      upcxx::allreduce(src.data(), dst.data(), n, plus<long>()).wait();
+      long ranks = upcxx::rank_n();
+      for (size_t i = 0; i < n; i++)
+          UPCXX_ASSERT_ALWAYS(dst[i] == ranks * (ranks - 1) / 2 + ranks * long(i),
+                              "Wrong element from array allreduce");
+      upcxx::allreduce(dst.data(), dst.data(), n, [](long a, long b) { return max(a, b); }).wait();
+      UPCXX_ASSERT_ALWAYS(dst[n - 1] == ranks * (ranks - 1) / 2 + ranks * long(n - 1),
+                          "Wrong element from in-place array allreduce");
+  }
+  upcxx::barrier();
+  if (!upcxx::rank_me()) cout << "array allreduce test: SUCCESS" << endl;
+
+  // persistent handles, with a few calls in flight at once
+  {
+      upcxx::allreduce_handle<int, plus<int>> sum{plus<int>()};
+      upcxx::broadcast_handle<int> bcast(upcxx::rank_n() / 2);
+      for (int i = 0; i < 100; i++) {
+          vector<upcxx::future<int>> sums, values;
+          for (int j = 0; j < 4; j++) {
+              sums.push_back(sum(tosend + j));
+              values.push_back(bcast(upcxx::rank_me() == upcxx::rank_n() / 2 ? i + j : -1));
+          }
+          for (int j = 0; j < 4; j++) {
+              UPCXX_ASSERT_ALWAYS(sums[j].wait() == expected_val + j * upcxx::rank_n(),
+                                  "Wrong value from allreduce_handle");
+              UPCXX_ASSERT_ALWAYS(values[j].wait() == i + j, "Wrong value from broadcast_handle");
+          }
+      }
+      upcxx::barrier();
+  }
+  {
+      // Pairs of calls in flight, a rendezvous-size value then a small one,
+      // so the small value overtakes the big one sent before it.
+      const int root = upcxx::rank_n() - 1;
+      upcxx::broadcast_handle<vector<char>> bcast(root, upcxx::world(), 2);
+      for (int i = 0; i < 20; i += 2) {
+          vector<upcxx::future<vector<char>>> gots;
+          for (int j = i; j < i + 2; j++) {
+              vector<char> value;
+              if (upcxx::rank_me() == root)
+                  value.assign(j % 2 ? 1 : 256 << 10, char(j));
+              gots.push_back(bcast(value));
+          }
+          for (int j = i; j < i + 2; j++) {
+              vector<char> got = gots[j - i].wait();
+              UPCXX_ASSERT_ALWAYS(got.size() == size_t(j % 2 ? 1 : 256 << 10) && got.back() == char(j),
+                                  "Wrong value from broadcast_handle with out of order arrivals");
+          }
+      }
+      upcxx::barrier();
+  }
+  if (!upcxx::rank_me()) cout << "collective handle test: SUCCESS" << endl;
+
+  // segment-slot collectives, repeated so slots and flags get reused
+  {
+      upcxx::rma_coll<double> coll;
+      for (int i = 0; i < 100; i++) {
+          double sum = coll.allreduce(tosend + i, plus<double>());
+          UPCXX_ASSERT_ALWAYS(sum == expected_val + double(i) * upcxx::rank_n(),
+                              "Wrong value from rma_coll::allreduce");
+          int root = i % upcxx::rank_n();
+          double value = coll.broadcast(upcxx::rank_me() == root ? i : -1, root);
+          UPCXX_ASSERT_ALWAYS(value == i, "Wrong value from rma_coll::broadcast");
+          coll.barrier();
+      }
+  }
+  if (!upcxx::rank_me()) cout << "rma_coll test: SUCCESS" << endl;
+
+  // prefix sums of rank_me+1, and a non-commutative op (string concat)
+  int incl = upcxx::inclusive_scan(tosend + 1, plus<int>()).wait();
+  int excl = upcxx::exclusive_scan(tosend + 1, plus<int>(), 0).wait();
+  UPCXX_ASSERT_ALWAYS(incl == (tosend + 1) * (tosend + 2) / 2, "Wrong inclusive_scan value");
+  UPCXX_ASSERT_ALWAYS(excl == tosend * (tosend + 1) / 2, "Wrong exclusive_scan value");
+  string order = upcxx::exclusive_scan(to_string(tosend) + ",", plus<string>(), string("<")).wait();
+  string expect_order = "<";
+  for (int r = 0; r < tosend; r++)
+      expect_order += to_string(r) + ",";
+  UPCXX_ASSERT_ALWAYS(order == expect_order, "exclusive_scan combined out of order");
+  upcxx::barrier();
+  if (!upcxx::rank_me()) cout << "scan test: SUCCESS" << endl;
+
+  // every rank checks in with rank 0 before entering the barrier, so once
+  // it completes rank 0 must have seen all of them
+  static int arrived = 0;
+  for (int i = 0; i < 10; i++) {
+      upcxx::rpc(0, []() { arrived++; }).wait();
+      upcxx::future<> fut3 = upcxx::barrier_async();
+      while (!fut3.ready())
+          upcxx::progress();
+      if (!upcxx::rank_me())
+          UPCXX_ASSERT_ALWAYS(arrived == upcxx::rank_n() * (i + 1), "barrier_async completed early");
+      upcxx::barrier_async().wait();
+  }
+  if (!upcxx::rank_me()) cout << "barrier_async test: SUCCESS" << endl;
+
   print_test_success();
   upcxx::finalize();
   return 0;
@@ -138,6 +138,40 @@ int main() {
     delete p;
   }
   
+  // range when_all over a batch, some of it ready from the start
+  {
+    vector<promise<int>*> pros;
+    vector<future<int>> batch;
+    for(int i=0; i < 100; i++) {
+      if(i % 3 == 0)
+        batch.push_back(make_future(i));
+      else {
+        pros.push_back(new promise<int>);
+        batch.push_back(pros.back()->get_future());
+      }
+    }
+    
+    future<> all = when_all(batch.begin(), batch.end());
+    int pending = 0;
+    for(promise<int> *p: pros) {
+      UPCXX_ASSERT_ALWAYS(!all.ready(), "range when_all ready early");
+      p->fulfill_result(pending++);
+      delete p;
+    }
+    UPCXX_ASSERT_ALWAYS(all.ready(), "range when_all not ready");
+    UPCXX_ASSERT_ALWAYS(when_all(batch.end(), batch.end()).ready(), "empty range when_all not ready");
+    
+    // one promise counting a whole batch down
+    promise<> counted;
+    counted.require_anonymous(50);
+    future<> counted_all = counted.finalize();
+    for(int i=0; i < 50; i++) {
+      UPCXX_ASSERT_ALWAYS(!counted_all.ready(), "counted promise ready early");
+      counted.fulfill_anonymous(1);
+    }
+    UPCXX_ASSERT_ALWAYS(counted_all.ready(), "counted promise not ready");
+  }
+  
   UPCXX_ASSERT_ALWAYS(ans2.ready(), "Answer is not ready");
   cout << "fib("<<(2*ans1.result())<<") = "<<ans2.result()<<'\n';
   UPCXX_ASSERT_ALWAYS(ans2.result() == 987, "expected 987, got " << ans2.result());
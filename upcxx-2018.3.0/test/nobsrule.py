@@ -11,6 +11,7 @@ REQUIRES_GASNET = [
 
 REQUIRES_PTHREAD = [
   'lpc_barrier.cpp',
+  'progress_thread.cpp',
   'uts/uts_threads.cpp',
   'uts/uts_hybrid.cpp',
 ]
@@ -0,0 +1,182 @@
+#include <upcxx/allocate.hpp>
+#include <upcxx/backend.hpp>
+#include <upcxx/bind.hpp>
+#include <upcxx/global_ptr.hpp>
+#include <upcxx/progress_thread.hpp>
+#include <upcxx/rget.hpp>
+#include <upcxx/rput.hpp>
+#include <upcxx/rpc.hpp>
+
+#include "util.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using upcxx::global_ptr;
+using upcxx::intrank_t;
+
+#if UPCXX_BACKEND_GASNET_PAR
+// Even ranks build a progress_thread and compute without calling
+// progress while their odd successor pushes rendezvous-size traffic at
+// them. rget and rput may complete without the even rank on shared
+// memory or RDMA conduits, so the odd rank also sends a rendezvous-size
+// internal-level AM and waits for the ack its body rputs back. Only the
+// even rank's internal progress, which only the progress thread can
+// supply, pulls that payload over and runs the body.
+
+const std::size_t big_n = 1<<18; // ints, well past the rendezvous cutover
+const int rpc_n = 4;
+
+global_ptr<int> src_arr, dst_arr, done_flag, ack_flag;
+int rpcs_got = 0;
+std::atomic<bool> served{false}; // the AM body ran here
+std::uint64_t volatile busy_sink;
+
+int pattern(intrank_t rank, std::size_t i) {
+  return int(rank*7919 + i);
+}
+
+void builder(intrank_t me, bool have_peer) {
+  int volatile *done = done_flag.local();
+  std::uint64_t sum = 0;
+  
+  auto t0 = std::chrono::steady_clock::now();
+  {
+    upcxx::progress_thread pt;
+    
+    // Busy work between peeks at our own memory; no upcxx calls.
+    while(have_peer && *done == 0) {
+      for(int i=0; i < 1<<16; i++)
+        sum = sum*6364136223846793005u + i;
+      
+      UPCXX_ASSERT_ALWAYS(
+        std::chrono::steady_clock::now() - t0 < std::chrono::seconds(60),
+        "Peer traffic never completed under the progress thread."
+      );
+    }
+    
+    if(have_peer) {
+      // The peer sets the flag only after our ack, so the AM was served
+      // by the progress thread while we are still in its scope.
+      UPCXX_ASSERT_ALWAYS(served.load(), "Done flag set before the AM was served");
+      
+      int *dst = dst_arr.local();
+      for(std::size_t i=0; i < big_n; i++)
+        UPCXX_ASSERT_ALWAYS(dst[i] == pattern(me+1, i), "Wrong value from peer's rput");
+    }
+  }
+  
+  // The rpc bodies are user-level, so they wait for our own progress.
+  while(have_peer && rpcs_got != rpc_n)
+    upcxx::progress();
+  
+  busy_sink = sum;
+}
+
+void peer(intrank_t me, intrank_t nebr,
+          global_ptr<int> nebr_src, global_ptr<int> nebr_dst, global_ptr<int> nebr_done) {
+  int volatile *ack = ack_flag.local();
+  global_ptr<int> my_ack = ack_flag;
+  
+  for(int r=0; r < rpc_n; r++) {
+    upcxx::rpc_ff(nebr,
+      [=](std::vector<int> const &v) {
+        UPCXX_ASSERT_ALWAYS(v.size() == big_n && v.back() == pattern(me, big_n-1 + r),
+          "Wrong rendezvous rpc payload"
+        );
+        rpcs_got += 1;
+      },
+      std::vector<int>(big_n, pattern(me, big_n-1 + r))
+    );
+  }
+  
+  std::vector<int> got(big_n);
+  upcxx::rget(nebr_src, got.data(), big_n).wait();
+  for(std::size_t i=0; i < big_n; i++)
+    UPCXX_ASSERT_ALWAYS(got[i] == pattern(nebr, i), "Wrong value from rget");
+  
+  std::vector<int> put(big_n);
+  for(std::size_t i=0; i < big_n; i++)
+    put[i] = pattern(me, i);
+  upcxx::rput(put.data(), nebr_dst, big_n).wait();
+  
+  upcxx::backend::send_am_master<upcxx::progress_level::internal>(nebr,
+    upcxx::bind(
+      [=](std::vector<int> const &v) {
+        UPCXX_ASSERT_ALWAYS(v.size() == big_n && v.back() == pattern(me, 0),
+          "Wrong rendezvous AM payload"
+        );
+        served.store(true);
+        upcxx::rput(1, my_ack);
+      },
+      std::vector<int>(big_n, pattern(me, 0))
+    )
+  );
+  
+  auto t0 = std::chrono::steady_clock::now();
+  while(*ack == 0) {
+    upcxx::progress();
+    UPCXX_ASSERT_ALWAYS(
+      std::chrono::steady_clock::now() - t0 < std::chrono::seconds(60),
+      "The progress thread never served our internal-level AM."
+    );
+  }
+  
+  upcxx::rput(1, nebr_done).wait();
+}
+#endif
+
+int main() {
+  upcxx::init();
+  
+  print_test_header();
+  
+  #if UPCXX_BACKEND_GASNET_PAR
+    intrank_t me = upcxx::rank_me();
+    intrank_t n = upcxx::rank_n();
+    
+    src_arr = upcxx::allocate<int>(big_n);
+    dst_arr = upcxx::allocate<int>(big_n);
+    done_flag = upcxx::allocate<int>();
+    *done_flag.local() = 0;
+    ack_flag = upcxx::allocate<int>();
+    *ack_flag.local() = 0;
+    for(std::size_t i=0; i < big_n; i++)
+      src_arr.local()[i] = pattern(me, i);
+    
+    upcxx::barrier();
+    
+    // Fetched before the builders stop answering user-level rpc's.
+    intrank_t nebr = me-1;
+    global_ptr<int> nebr_src, nebr_dst, nebr_done;
+    if(me % 2 == 1) {
+      nebr_src = upcxx::rpc(nebr, []() { return src_arr; }).wait();
+      nebr_dst = upcxx::rpc(nebr, []() { return dst_arr; }).wait();
+      nebr_done = upcxx::rpc(nebr, []() { return done_flag; }).wait();
+    }
+    
+    upcxx::barrier();
+    
+    if(me % 2 == 0)
+      builder(me, me+1 < n);
+    else
+      peer(me, nebr, nebr_src, nebr_dst, nebr_done);
+    
+    upcxx::barrier();
+    
+    upcxx::deallocate(src_arr);
+    upcxx::deallocate(dst_arr);
+    upcxx::deallocate(done_flag);
+    upcxx::deallocate(ack_flag);
+  #else
+    if(upcxx::rank_me() == 0)
+      std::cout << "Skipping: progress_thread needs UPCXX_THREADMODE=par." << std::endl;
+  #endif
+  
+  print_test_success();
+  
+  upcxx::finalize();
+  return 0;
+}
@@ -1,5 +1,6 @@
 #include <upcxx/backend.hpp>
 #include <upcxx/rpc.hpp>
+#include <upcxx/rpc_aggregator.hpp>
 
 #include <iostream>
 
@@ -12,6 +13,8 @@ using std::endl;
 
 bool *from_nebrs;
 bool done = false;
+int aggregated = 0;
+bool timed_out = false;
 
 void arrive(upcxx::intrank_t origin) {
   if (rank_me() == origin)
@@ -56,6 +59,29 @@ int main() {
     if (i == me) continue;
     UPCXX_ASSERT_ALWAYS(from_nebrs[i], "From neighbor " << i << "is not set");
   }
+  
+  // many tiny rpc's to everyone through an aggregator, some flushed by
+  // size, the rest by the explicit flush
+  {
+    upcxx::rpc_aggregator agg;
+    for (int i = 0; i < 10000; i++) {
+      for (int r = 0; r < rank_n(); r++)
+        agg.rpc_ff(r, [](int x) { aggregated += x; }, 1);
+    }
+    agg.flush();
+  }
+  while (aggregated != 10000*rank_n())
+    upcxx::progress();
+  upcxx::barrier();
+  
+  // a lone rpc to the neighbor, only progress's timeout sends it
+  {
+    upcxx::rpc_aggregator agg(1<<20, 50);
+    agg.rpc_ff((rank_me() + 1)%rank_n(), []() { timed_out = true; });
+    while (!timed_out)
+      upcxx::progress();
+    upcxx::barrier();
+  }
 
   print_test_success();
   
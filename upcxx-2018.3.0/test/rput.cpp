@@ -2,10 +2,17 @@
 #include <upcxx/global_ptr.hpp>
 #include <upcxx/rput.hpp>
 #include <upcxx/rget.hpp>
+#include <upcxx/rma_region.hpp>
 #include <upcxx/rpc.hpp>
+#include <upcxx/stats.hpp>
+#include <upcxx/vis.hpp>
 
 #include "util.hpp"
 
+#include <array>
+#include <utility>
+#include <vector>
+
 using upcxx::global_ptr;
 using upcxx::intrank_t;
 using upcxx::future;
@@ -15,7 +22,9 @@ using upcxx::source_cx;
 using upcxx::remote_cx;
 
 global_ptr<int> my_thing;
+global_ptr<int> my_arr;
 int got_rpc = 0;
+int fused_seen = -1, big_seen = -1;
 
 int main() {
   upcxx::init();
@@ -83,6 +92,152 @@ int main() {
   while(got_rpc != 2)
     upcxx::progress();
   
+  // Operation and remote completion only: payload and rpc go out fused
+  // in one AM long, unless the payload is past the fusing cap.
+  {
+    intrank_t prev = (me + n - 1) % n;
+    
+    int fused_value = 200 + me;
+    upcxx::rput(&fused_value, nebr_thing, 1,
+      operation_cx::as_future() |
+      remote_cx::as_rpc([]() { fused_seen = *my_thing.local(); })
+    ).wait();
+    while(fused_seen != 200 + prev)
+      upcxx::progress();
+    
+    std::size_t big_n = upcxx::backend::gasnet::am_size_fused_max/sizeof(int) + 1;
+    my_arr = upcxx::allocate<int>(big_n);
+    upcxx::barrier();
+    global_ptr<int> nebr_arr = upcxx::rpc(nebr, []() { return my_arr; }).wait();
+    
+    std::vector<int> big(big_n, me);
+    upcxx::rput(big.data(), nebr_arr, big_n,
+      operation_cx::as_future() |
+      remote_cx::as_rpc([=]() { big_seen = my_arr.local()[big_n - 1]; })
+    ).wait();
+    while(big_seen != prev)
+      upcxx::progress();
+    
+    upcxx::barrier();
+    upcxx::deallocate(my_arr);
+  }
+  
+  // many puts sharing one sync point, then read back outside the region
+  {
+    const int k = 1000;
+    my_arr = upcxx::allocate<int>(k);
+    upcxx::barrier();
+    global_ptr<int> nebr_arr = upcxx::rpc(nebr, []() { return my_arr; }).wait();
+    
+    std::vector<int> vals(k);
+    std::vector<future<>> puts;
+    {
+      upcxx::rma_region region;
+      for(int i=0; i < k; i++) {
+        vals[i] = me*k + i;
+        puts.push_back(upcxx::rput(&vals[i], nebr_arr + i, 1));
+      }
+    }
+    for(future<> &f: puts)
+      f.wait();
+    
+    std::vector<int> back(k);
+    upcxx::rget(nebr_arr, back.data(), k).wait();
+    for(int i=0; i < k; i++)
+      UPCXX_ASSERT_ALWAYS(back[i] == me*k + i, "rma_region put lost");
+    
+    upcxx::barrier();
+    upcxx::deallocate(my_arr);
+  }
+  
+  // non-contiguous transfers into an 8x8 tile on the neighbor
+  {
+    const int w = 8;
+    my_arr = upcxx::allocate<int>(w*w);
+    upcxx::barrier();
+    global_ptr<int> nebr_arr = upcxx::rpc(nebr, []() { return my_arr; }).wait();
+    
+    std::vector<int> tile(w*w);
+    for(int i=0; i < w*w; i++)
+      tile[i] = me*w*w + i;
+    
+    const std::ptrdiff_t row = w*sizeof(int);
+    upcxx::rput_strided<2>(
+      tile.data(), {{sizeof(int), row}},
+      nebr_arr, {{sizeof(int), row}},
+      {{w, w}}
+    ).wait();
+    
+    // column 0
+    std::vector<int> col(w);
+    upcxx::rget_strided<1>(
+      nebr_arr, {{row}},
+      col.data(), {{sizeof(int)}},
+      {{w}}
+    ).wait();
+    for(int i=0; i < w; i++)
+      UPCXX_ASSERT_ALWAYS(col[i] == tile[i*w], "rput_strided/rget_strided mismatch");
+    
+    // source and destination cut at different points
+    int src[8] = {-1, -2, -3, -4, -5, -6, -7, -8};
+    std::vector<std::pair<int const*, std::size_t>> src_runs = {{src, 3}, {src + 3, 5}};
+    std::vector<std::pair<global_ptr<int>, std::size_t>> dest_runs = {{nebr_arr, 2}, {nebr_arr + 10, 6}};
+    upcxx::rput_irregular(
+      src_runs.begin(), src_runs.end(),
+      dest_runs.begin(), dest_runs.end()
+    ).wait();
+    
+    // rows 0 and 1
+    std::vector<int> rows(2*w);
+    std::vector<global_ptr<int>> row_ptrs = {nebr_arr, nebr_arr + w};
+    std::vector<int*> rows_ptr = {rows.data()};
+    upcxx::rget_regular(
+      row_ptrs.begin(), row_ptrs.end(), w,
+      rows_ptr.begin(), rows_ptr.end(), 2*w
+    ).wait();
+    for(int i=0; i < 2*w; i++) {
+      int expect = i < 2 ? src[i] : 10 <= i && i < 16 ? src[i-8] : tile[i];
+      UPCXX_ASSERT_ALWAYS(rows[i] == expect, "rput_irregular/rget_regular mismatch");
+    }
+    
+    // column 1 from a contiguous array and back, both packed
+    std::vector<int> col1(w), back1(w);
+    for(int i=0; i < w; i++)
+      col1[i] = -100*me - i;
+    upcxx::rput_strided<1>(
+      col1.data(), {{sizeof(int)}},
+      nebr_arr + 1, {{row}},
+      {{w}}
+    ).wait();
+    upcxx::rget_strided<1>(
+      nebr_arr + 1, {{row}},
+      back1.data(), {{sizeof(int)}},
+      {{w}},
+      operation_cx::as_blocking()
+    );
+    UPCXX_ASSERT_ALWAYS(back1 == col1, "packed rput_strided/rget_strided mismatch");
+    
+    upcxx::barrier();
+    upcxx::deallocate(my_arr);
+  }
+  
+  // counters see our own traffic only
+  {
+    upcxx::stats_reset();
+    int x = me;
+    upcxx::rput(&x, nebr_thing, 1).wait();
+    upcxx::rget(nebr_thing).wait();
+    upcxx::stats_t st = upcxx::stats();
+    #if UPCXX_STATS_ENABLED
+      UPCXX_ASSERT_ALWAYS(st.rput_n == 1 && st.rput_bytes == sizeof(int), "stats missed an rput");
+      UPCXX_ASSERT_ALWAYS(st.rget_n == 1 && st.rget_bytes == sizeof(int), "stats missed an rget");
+      UPCXX_ASSERT_ALWAYS(st.progress_n != 0, "stats missed progress");
+    #else
+      UPCXX_ASSERT_ALWAYS(st.rput_n == 0 && st.progress_n == 0, "stats counted while compiled out");
+    #endif
+    upcxx::barrier();
+  }
+  
   //upcxx::barrier();
   
   upcxx::deallocate(my_thing);
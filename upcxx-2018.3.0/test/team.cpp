@@ -0,0 +1,65 @@
+#include <iostream>
+#include <upcxx/backend.hpp>
+#include <upcxx/allreduce.hpp>
+#include <upcxx/broadcast.hpp>
+#include <upcxx/dist_object.hpp>
+#include <upcxx/team.hpp>
+
+#include "util.hpp"
+
+using namespace std;
+
+int main() {
+  upcxx::init();
+
+  print_test_header();
+  
+  upcxx::team &world = upcxx::world();
+  UPCXX_ASSERT_ALWAYS(world.rank_n() == upcxx::rank_n(), "world has the wrong size");
+  UPCXX_ASSERT_ALWAYS(world.rank_me() == upcxx::rank_me(), "world has the wrong rank");
+  
+  // split into even and odd ranks, ordered backwards
+  int me = upcxx::rank_me();
+  int color = me % 2;
+  upcxx::team half(world, color, -me);
+  
+  int expect_n = (upcxx::rank_n() + 1 - color) / 2;
+  UPCXX_ASSERT_ALWAYS(half.rank_n() == expect_n, "split team has the wrong size");
+  UPCXX_ASSERT_ALWAYS(half[half.rank_me()] == me, "split team rank does not map back to world rank");
+  UPCXX_ASSERT_ALWAYS(half.from_world(me) == half.rank_me(), "from_world is not the inverse of operator[]");
+  if (half.rank_me() > 0)
+    UPCXX_ASSERT_ALWAYS(half[half.rank_me() - 1] > me, "split team not ordered by key");
+  
+  // collectives among the half only
+  int sum = upcxx::allreduce(me, plus<int>(), half).wait();
+  int expect_sum = 0;
+  for (int r = color; r < upcxx::rank_n(); r += 2)
+    expect_sum += r;
+  UPCXX_ASSERT_ALWAYS(sum == expect_sum, "team allreduce has the wrong value");
+  
+  for (int root = 0; root < half.rank_n(); root++) {
+    int got = upcxx::broadcast(me, root, half).wait();
+    UPCXX_ASSERT_ALWAYS(got == half[root], "team broadcast has the wrong value");
+  }
+  upcxx::barrier(half);
+  
+  { // team-scoped dist_object, fetch by team rank
+    upcxx::dist_object<int> obj(100 + me, half);
+    int nebr = (half.rank_me() + 1) % half.rank_n();
+    UPCXX_ASSERT_ALWAYS(obj.fetch(nebr).wait() == 100 + half[nebr], "team dist_object fetched the wrong value");
+    upcxx::barrier_async(half).wait();
+  }
+  
+  // node-local ranks always include this one
+  upcxx::team &local = upcxx::local_team();
+  UPCXX_ASSERT_ALWAYS(local[local.rank_me()] == me, "local_team does not contain this rank");
+  int local_n = upcxx::allreduce(1, plus<int>(), local).wait();
+  UPCXX_ASSERT_ALWAYS(local_n == local.rank_n(), "local_team allreduce has the wrong value");
+  
+  upcxx::barrier();
+  if (!upcxx::rank_me()) cout << "team test: SUCCESS" << endl;
+  
+  print_test_success();
+  upcxx::finalize();
+  return 0;
+}